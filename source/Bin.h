@@ -11,6 +11,8 @@
 #include <RectMapping.h>
 #include <NodeAllocator.h>
 #include <Node.h>
+#include <DirtyRegion.h>
+#include <PackStats.h>
 
 namespace binpacking
 {
@@ -20,12 +22,16 @@ struct Bin
     Size size;
     NodePtr root;
     std::list<RectMapping> mappings;
+    DirtyRegion dirtyRegion; // dynamic packing only
+    PackStats stats; // only collected if BINPACKING_STATS is enabled
+    int sortOrder = -1; // static packing only: index of the sort order that won
 
     Bin(){}
     Bin(const Size& size) : size(size){}
 
     Bin(Bin&& bin) noexcept
-        : size(bin.size), root(std::move(bin.root)), mappings(move(bin.mappings))
+        : size(bin.size), root(std::move(bin.root)), mappings(move(bin.mappings)),
+        dirtyRegion(std::move(bin.dirtyRegion)), stats(bin.stats), sortOrder(bin.sortOrder)
     {
         bin.size = Size();
     }
@@ -36,6 +42,9 @@ struct Bin
         bin.size = Size();
         root = std::move(bin.root);
         mappings = move(bin.mappings);
+        dirtyRegion = std::move(bin.dirtyRegion);
+        stats = bin.stats;
+        sortOrder = bin.sortOrder;
         return *this;
     }
 
@@ -0,0 +1,1157 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <BinPacking.h>
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <stdexcept>
+#include <cmath>
+#include <cassert>
+#include <cstdint>
+
+using namespace std;
+
+namespace binpacking
+{
+
+Bin BinPacker::PackBin(
+    std::vector<RectMapping>& input,
+    const std::vector<Size>& binSizes,
+    int padding,
+    bool allowRotation,
+    std::vector<RectMapping>& overflow)
+{
+    TraceScope trace("PackBin", "boxes", (int64_t)input.size());
+
+    // boxes without area don't change the outcome of a trial, so they're placed afterward
+    auto firstEmpty = std::stable_partition(input.begin(), input.end(),
+        [](const RectMapping& loc) { return loc.inputSize.area() > 0; });
+
+    std::array<bool, NumBinComparison> enabled;
+    SelectComparisons(enabled);
+
+    for(size_t i = 0; i < binComparisons.size(); ++i)
+    {
+        if(!enabled[i])
+            continue;
+
+        TraceScope sortTrace("Sort", "comparator", (int64_t)i);
+        sortedInput[i].assign(input.begin(), firstEmpty);
+        sort(sortedInput[i].begin(), sortedInput[i].end(), binComparisons[i]);
+    }
+
+    int largestArea = 0;
+    int bestOrderIndex = -1;
+    int bestSize = 0;
+    int accepted = 0;
+    int remaining = 0;
+
+    NodePtr root = nodeAllocator->GetNode();
+
+    for(size_t i = 0; i < binComparisons.size(); ++i)
+    {
+        if(!enabled[i])
+            continue;
+
+        int binSizeCount = (int)binSizes.size();
+        for(int size = bestSize; size < binSizeCount; ++size)
+        {
+            TraceScope trialTrace("Trial", "comparator", (int64_t)i, "sizeIndex", size);
+            int area = 0;
+
+            Size sz = binSizes[size];
+            root->Reset(Rect(0, 0, sz.x, sz.y));
+            BINPACKING_STAT(binTrials);
+
+            int acc = 0;
+            int rem = 0;
+
+            for(auto& loc : sortedInput[i])
+            {
+                if(root->Insert(loc, padding, allowRotation)) {
+                    area += loc.mappedRect.area();
+                    ++acc;
+                }
+                else {
+                    ++rem;
+                    BINPACKING_STAT(failedInserts);
+                }
+            }
+
+            if((area > largestArea && size >= bestSize)
+            || (size > bestSize && area >= largestArea))
+            {
+                largestArea = area;
+                bestOrderIndex = i;
+                bestSize = size;
+                accepted = acc;
+                remaining = rem;
+            }
+            else
+            {
+                break;
+            }
+        }
+    }
+
+    Bin bin;
+
+    if(bestOrderIndex < 0)
+    {
+        // only boxes without area are left, and they all fit in the largest bin
+        assert(firstEmpty == input.begin());
+        bin.size = binSizes[0];
+        root->Reset(Rect(bin.size));
+    }
+    else
+    {
+        RecordWin(bestOrderIndex, bestSize);
+
+        bin.size = binSizes[bestSize];
+        bin.sortOrder = bestOrderIndex;
+        bin.mappings;
+        overflow.reserve(remaining);
+
+        TraceScope finalTrace("FinalPass", "comparator", bestOrderIndex, "sizeIndex", bestSize);
+        root->Reset(Rect(bin.size));
+
+        for(auto& loc : sortedInput[bestOrderIndex])
+        {
+            auto node = root->Insert(loc, padding, allowRotation);
+            if (node) {
+                bin.mappings.push_back(loc);
+                node->pMapping = &bin.mappings.back();
+            }
+            else {
+                overflow.push_back(loc);
+            }
+        }
+    }
+
+    // boxes without area take no space, but still have to be inside the bin
+    for(auto it = firstEmpty; it != input.end(); ++it)
+    {
+        RectMapping loc = *it;
+        Size sz = loc.inputSize;
+        loc.rotated = (sz.x > bin.size.x || sz.y > bin.size.y) && allowRotation;
+
+        if(loc.rotated)
+            std::swap(sz.x, sz.y);
+
+        if(sz.x <= bin.size.x && sz.y <= bin.size.y) {
+            loc.mappedRect = Rect(0, 0, sz.x, sz.y);
+            bin.mappings.push_back(loc);
+        }
+        else {
+            loc.rotated = false;
+            overflow.push_back(loc);
+        }
+    }
+
+    if (keepNodeTrees)
+    {
+        // only the final pass is measured, so drop the subtrees left over from the trials
+        ReleaseSpareNodes(root.get());
+        bin.root = std::move(root);
+    }
+
+    return bin;
+}
+
+void BinPacker::SelectComparisons(std::array<bool, NumBinComparison>& enabled)
+{
+    enabled.fill(true);
+
+    // try everything until the window fills up, and every so often after that
+    bool explore = !adaptiveOrdering
+        || (int)recentWinners.size() < adaptiveWindow
+        || heuristicStats.bins % adaptiveExploreInterval == 0;
+
+    if (explore)
+        return;
+
+    enabled.fill(false);
+
+    for (int winner : recentWinners)
+        enabled[winner] = true;
+
+    for (int i = 0; i < NumBinComparison; ++i)
+    {
+        if (!enabled[i])
+            ++heuristicStats.skippedOrders;
+    }
+}
+
+void BinPacker::RecordWin(int orderIndex, int sizeIndex)
+{
+    ++heuristicStats.bins;
+    ++heuristicStats.orderWins[orderIndex];
+
+    if (sizeIndex >= (int)heuristicStats.sizeWins.size())
+        heuristicStats.sizeWins.resize(sizeIndex + 1);
+
+    ++heuristicStats.sizeWins[sizeIndex];
+
+    recentWinners.push_back(orderIndex);
+
+    while ((int)recentWinners.size() > adaptiveWindow)
+        recentWinners.pop_front();
+}
+
+void BinPacker::SetAdaptiveOrdering(bool enabled, int window, int exploreInterval)
+{
+    if (window < 1 || exploreInterval < 1)
+        throw std::runtime_error("'window' and 'exploreInterval' must be positive");
+
+    adaptiveOrdering = enabled;
+    adaptiveWindow = window;
+    adaptiveExploreInterval = exploreInterval;
+
+    while ((int)recentWinners.size() > adaptiveWindow)
+        recentWinners.pop_front();
+}
+
+BinPacker::Options BinPacker::GetOptions() const
+{
+    Options options;
+    options.adaptiveOrdering = adaptiveOrdering;
+    options.adaptiveWindow = adaptiveWindow;
+    options.adaptiveExploreInterval = adaptiveExploreInterval;
+    return options;
+}
+
+void BinPacker::ResetHeuristicStats()
+{
+    heuristicStats = HeuristicStats();
+    recentWinners.clear();
+}
+
+void BinPacker::PackBoxes(const std::vector<Size>& boxes, int maxSize, int padding, bool allowRotation)
+{
+    if(maxSize <= 0 || (maxSize & (maxSize - 1)) != 0)
+        throw std::runtime_error("'maxSize' must be a power of two");
+
+    dynamicPacking = false;
+    stats = PackStats();
+    StatsScope scope(stats);
+    TraceScope trace("PackBoxes", "boxes", (int64_t)boxes.size());
+
+    input.clear();
+    overflow.clear();
+
+    {
+        TraceScope copyTrace("CopyInput");
+        input.reserve(boxes.size());
+        int inputIndex = 0;
+
+        for(auto& box : boxes)
+        {
+            if(box.x > maxSize || box.y > maxSize)
+                throw std::runtime_error("all boxes must fit inside bounds 'maxSize'x'maxSize'");
+
+            input.push_back(RectMapping(box, inputIndex++));
+        }
+    }
+    
+    binSizes.clear();
+    binSizes.reserve((int)(log2(maxSize) * 3 + 0.5));
+
+    for(int binSize = maxSize; binSize > 1; binSize /= 2)
+    {
+        binSizes.push_back(Size(binSize, binSize));
+        binSizes.push_back(Size(binSize, binSize / 2));
+        binSizes.push_back(Size(binSize / 2, binSize));
+    }
+
+    if(binSizes.empty())
+        binSizes.push_back(Size(maxSize, maxSize));
+
+    bins.clear();
+    bins.reserve(4);
+
+    while(true)
+    {
+        PackStats binStats;
+        Bin bin;
+        {
+            StatsScope binScope(binStats);
+            bin = PackBin(input, binSizes, padding, allowRotation, overflow);
+        }
+        TraceScope finalizeTrace("FinalizeBin", "bin", (int64_t)bins.size());
+        bin.stats = binStats;
+        bins.emplace_back(move(bin));
+
+        if(overflow.empty())
+            break;
+
+        overflow.swap(input);
+        overflow.clear();
+    }
+}
+
+void BinPacker::SetRecorder(DynamicTraceRecorder* recorder)
+{
+    // a trace has to begin with StartDynamicPacking to be replayed
+    if (recorder && dynamicPacking)
+        throw std::runtime_error("recording must start before 'StartDynamicPacking'");
+
+    this->recorder = recorder;
+}
+
+void BinPacker::StartDynamicPacking(int binSize, int boxPadding, bool allowRotation)
+{
+    dynamicPacking = true;
+    this->binSize = binSize;
+    this->boxPadding = boxPadding;
+    this->allowRotation = allowRotation;
+
+    if (recorder)
+        recorder->RecordStart(binSize, boxPadding, allowRotation);
+
+    bins.clear();
+    dynamicBoxes.clear();
+
+    AddDynamicBin();
+}
+
+RectMapping BinPacker::PackBox(const Size& box)
+{
+    if (!dynamicPacking)
+        throw std::runtime_error("'StartDynamicPacking' must be called first");
+
+    if(box.x <= 0 || box.y <= 0)
+        throw std::runtime_error("box size must be positive");
+
+    if(box.x > binSize || box.y > binSize)
+        throw std::runtime_error("box is too large");
+
+    if (recorder)
+        recorder->RecordPackBox(box, (int)dynamicBoxes.size());
+
+    stats = PackStats();
+    StatsScope scope(stats);
+    TraceScope trace("PackBox");
+    
+    int handle = (int)dynamicBoxes.size();
+    dynamicBoxes.push_back(DynamicBox());
+
+    int i = 0;
+
+    for ( ; i < (int)bins.size(); ++i)
+    {
+        if (InsertDynamicBox(i, box, handle))
+            break;
+    }
+
+    if (i == (int)bins.size())
+    {
+        AddDynamicBin();
+        bool inserted = InsertDynamicBox(i, box, handle);
+        assert(inserted);
+    }
+
+    return *dynamicBoxes[handle].mapping;
+}
+
+std::vector<RectMapping> BinPacker::PackBoxBatch(const std::vector<Size>& boxes)
+{
+    if (!dynamicPacking)
+        throw std::runtime_error("'StartDynamicPacking' must be called first");
+
+    stats = PackStats();
+    SortDynamicInput(boxes);
+
+    if (recorder)
+        recorder->RecordPackBatch(boxes, boxes.empty() ? -1 : (int)dynamicBoxes.size());
+
+    int firstHandle = (int)dynamicBoxes.size();
+    dynamicBoxes.resize(dynamicBoxes.size() + boxes.size());
+
+    size_t binCount = bins.size();
+    std::vector<DirtyRegion> dirtyRegions;
+    std::vector<PackStats> binStats;
+
+    for (auto& bin : bins)
+    {
+        dirtyRegions.push_back(bin.dirtyRegion);
+        binStats.push_back(bin.stats);
+    }
+
+    // removes the batch and anything it recorded in the bins
+    auto undo = [&]() {
+        RemoveDynamicInput(firstHandle);
+
+        while (bins.size() > binCount)
+            bins.pop_back();
+
+        for (size_t b = 0; b < binCount; ++b)
+        {
+            bins[b].dirtyRegion = dirtyRegions[b];
+            bins[b].stats = binStats[b];
+        }
+    };
+
+    // area used in the bins the batch added
+    auto newBinArea = [&]() {
+        int64_t area = 0;
+
+        for (size_t b = binCount; b < bins.size(); ++b)
+        {
+            for (auto& mapping : bins[b].mappings)
+                area += mapping.mappedRect.area();
+        }
+
+        return area;
+    };
+
+    {
+        StatsScope scope(stats);
+        PlaceDynamicInput(firstHandle);
+    }
+
+    if (bins.size() > binCount && boxes.size() > 1)
+    {
+        // area order needed new bins, so see if another order needs fewer,
+        // or leaves more room in them for the boxes that come later
+        int bestOrderIndex = 0;
+        size_t fewestBins = bins.size();
+        int64_t leastNewArea = newBinArea();
+
+        undo();
+        stats = PackStats();
+
+        for (int i = 1; i < NumBinComparison; ++i)
+        {
+            SortDynamicInput(boxes, i);
+            PlaceDynamicInput(firstHandle);
+
+            int64_t area = newBinArea();
+
+            if (bins.size() < fewestBins || (bins.size() == fewestBins && area < leastNewArea))
+            {
+                fewestBins = bins.size();
+                leastNewArea = area;
+                bestOrderIndex = i;
+            }
+
+            undo();
+        }
+
+        SortDynamicInput(boxes, bestOrderIndex);
+
+        StatsScope scope(stats);
+        PlaceDynamicInput(firstHandle);
+    }
+
+    return GetDynamicMappings(firstHandle, (int)boxes.size());
+}
+
+void BinPacker::PlaceDynamicInput(int firstHandle)
+{
+    for (auto& loc : input)
+    {
+        int handle = firstHandle + loc.inputIndex;
+        int i = 0;
+
+        for ( ; i < (int)bins.size(); ++i)
+        {
+            if (InsertDynamicBox(i, loc.inputSize, handle))
+                break;
+        }
+
+        if (i == (int)bins.size())
+        {
+            AddDynamicBin();
+            bool inserted = InsertDynamicBox(i, loc.inputSize, handle);
+            assert(inserted);
+        }
+    }
+}
+
+void BinPacker::RemoveDynamicInput(int firstHandle)
+{
+    // removing boxes in reverse order restores the trees to their previous state
+    for (size_t i = input.size(); i-- > 0; )
+    {
+        auto& entry = dynamicBoxes[firstHandle + input[i].inputIndex];
+        RemoveDynamicBox(entry);
+        entry.bin = -1;
+    }
+}
+
+void BinPacker::BeginTransaction(bool singleBin)
+{
+    if (!dynamicPacking)
+        throw std::runtime_error("'StartDynamicPacking' must be called first");
+
+    if (inTransaction)
+        throw std::runtime_error("a transaction is already in progress");
+
+    inTransaction = true;
+    transactionSingleBin = singleBin;
+    stagedBoxes.clear();
+}
+
+int BinPacker::StageBox(const Size& box)
+{
+    if (!inTransaction)
+        throw std::runtime_error("'BeginTransaction' must be called first");
+
+    if(box.x <= 0 || box.y <= 0)
+        throw std::runtime_error("box size must be positive");
+
+    if(box.x > binSize || box.y > binSize)
+        throw std::runtime_error("box is too large");
+
+    stagedBoxes.push_back(box);
+    return (int)stagedBoxes.size() - 1;
+}
+
+bool BinPacker::CommitTransaction(std::vector<RectMapping>& mappings)
+{
+    if (!inTransaction)
+        throw std::runtime_error("'BeginTransaction' must be called first");
+
+    inTransaction = false;
+    mappings.clear();
+
+    if (!transactionSingleBin)
+    {
+        mappings = PackBoxBatch(stagedBoxes);
+        return true;
+    }
+
+    stats = PackStats();
+    StatsScope scope(stats);
+
+    SortDynamicInput(stagedBoxes);
+
+    int firstHandle = (int)dynamicBoxes.size();
+    dynamicBoxes.resize(dynamicBoxes.size() + stagedBoxes.size());
+
+    // try every existing bin, then an empty one
+    int binCount = (int)bins.size();
+    AddDynamicBin();
+
+    for (int i = 0; i <= binCount; ++i)
+    {
+        if (InsertDynamicBoxes(i, firstHandle))
+        {
+            if (i < binCount)
+                bins.pop_back();
+
+            mappings = GetDynamicMappings(firstHandle, (int)stagedBoxes.size());
+
+            if (recorder)
+                recorder->RecordPackSingleBin(stagedBoxes, stagedBoxes.empty() ? -1 : firstHandle);
+
+            return true;
+        }
+    }
+
+    bins.pop_back();
+    dynamicBoxes.resize(firstHandle);
+
+    if (recorder)
+        recorder->RecordPackSingleBin(stagedBoxes, -1);
+
+    return false;
+}
+
+void BinPacker::RollbackTransaction()
+{
+    if (!inTransaction)
+        throw std::runtime_error("'BeginTransaction' must be called first");
+
+    inTransaction = false;
+    stagedBoxes.clear();
+}
+
+void BinPacker::FreeBox(int handle)
+{
+    if (!dynamicPacking)
+        throw std::runtime_error("'StartDynamicPacking' must be called first");
+
+    if (handle < 0 || handle >= (int)dynamicBoxes.size() || dynamicBoxes[handle].bin < 0)
+        throw std::runtime_error("invalid box handle");
+
+    if (recorder)
+        recorder->RecordFreeBox(handle);
+
+    RemoveDynamicBox(dynamicBoxes[handle]);
+    dynamicBoxes[handle].bin = -1;
+}
+
+std::vector<BoxMove> BinPacker::Compact(int maxMoves, std::chrono::microseconds timeLimit)
+{
+    if (!dynamicPacking)
+        throw std::runtime_error("'StartDynamicPacking' must be called first");
+
+    if (recorder)
+        recorder->RecordCompact(maxMoves, timeLimit);
+
+    stats = PackStats();
+    StatsScope scope(stats);
+
+    using clock = std::chrono::steady_clock;
+    auto deadline = clock::now() + timeLimit;
+    bool timed = timeLimit > std::chrono::microseconds::zero();
+
+    std::vector<BoxMove> moves;
+    std::vector<RectMapping*> candidates;
+    std::vector<int> order(bins.size());
+    std::vector<int> liveArea(bins.size());
+    std::vector<int> rank(bins.size());
+    bool outOfBudget = false;
+
+    for (int i = 0; i < (int)bins.size(); ++i)
+    {
+        order[i] = i;
+        for (auto& mapping : bins[i].mappings)
+            liveArea[i] += mapping.mappedRect.area();
+    }
+
+    // Evacuate the emptiest bins first, moving their boxes into fuller ones.
+    // Ties go to later bins so that trailing pages can be released.
+    // A bin is skipped once one of its boxes doesn't fit anywhere else.
+    sort(order.begin(), order.end(),
+        [&](int a, int b) {
+            return liveArea[a] != liveArea[b] ? liveArea[a] < liveArea[b] : a > b;
+        });
+
+    for (int i = 0; i < (int)order.size(); ++i)
+        rank[order[i]] = i;
+    
+    for (int k = 0; k < (int)order.size() - 1 && !outOfBudget; ++k)
+    {
+        int src = order[k];
+        candidates.clear();
+        
+        for (auto& mapping : bins[src].mappings)
+            candidates.push_back(&mapping);
+
+        sort(candidates.begin(), candidates.end(),
+            [](const RectMapping* a, const RectMapping* b) {
+                return a->inputSize.area() > b->inputSize.area();
+            });
+
+        for (auto pMapping : candidates)
+        {
+            if ((int)moves.size() >= maxMoves || (timed && clock::now() >= deadline))
+            {
+                outOfBudget = true;
+                break;
+            }
+
+            BoxMove move;
+            move.handle = pMapping->handle;
+            move.oldBin = src;
+            move.oldRect = pMapping->mappedRect;
+            move.oldRotated = pMapping->rotated;
+
+            DynamicBox oldEntry = dynamicBoxes[move.handle];
+            int dst = 0;
+            
+            for ( ; dst < (int)bins.size(); ++dst)
+            {
+                if (rank[dst] > k && InsertDynamicBox(dst, pMapping->inputSize, move.handle))
+                    break;
+            }
+
+            if (dst == (int)bins.size())
+                break;
+
+            RemoveDynamicBox(oldEntry);
+
+            auto& mapping = *dynamicBoxes[move.handle].mapping;
+            move.newBin = dst;
+            move.newRect = mapping.mappedRect;
+            move.newRotated = mapping.rotated;
+            moves.push_back(move);
+        }
+    }
+
+    while (bins.size() > 1 && bins.back().mappings.empty())
+        bins.pop_back();
+
+    return moves;
+}
+
+void BinPacker::SortDynamicInput(const std::vector<Size>& boxes, int orderIndex)
+{
+    input.clear();
+    input.reserve(boxes.size());
+    int inputIndex = 0;
+
+    for (auto& box : boxes)
+    {
+        if(box.x <= 0 || box.y <= 0)
+            throw std::runtime_error("box size must be positive");
+
+        if(box.x > binSize || box.y > binSize)
+            throw std::runtime_error("box is too large");
+
+        input.push_back(RectMapping(box, inputIndex++));
+    }
+
+    stable_sort(input.begin(), input.end(), binComparisons[orderIndex]);
+}
+
+bool BinPacker::InsertDynamicBoxes(int binIndex, int firstHandle)
+{
+    // the dirty region is restored on failure, since nothing really changed
+    DirtyRegion dirtyRegion = bins[binIndex].dirtyRegion;
+    size_t inserted = 0;
+
+    for ( ; inserted < input.size(); ++inserted)
+    {
+        int handle = firstHandle + input[inserted].inputIndex;
+        if (!InsertDynamicBox(binIndex, input[inserted].inputSize, handle))
+            break;
+    }
+
+    if (inserted == input.size())
+        return true;
+
+    // removing boxes in reverse order restores the tree to its previous state
+    while (inserted-- > 0)
+    {
+        auto& entry = dynamicBoxes[firstHandle + input[inserted].inputIndex];
+        RemoveDynamicBox(entry);
+        entry.bin = -1;
+    }
+
+    bins[binIndex].dirtyRegion = dirtyRegion;
+    return false;
+}
+
+std::vector<RectMapping> BinPacker::GetDynamicMappings(int firstHandle, int count)
+{
+    std::vector<RectMapping> mappings;
+    mappings.reserve(count);
+
+    for (int i = 0; i < count; ++i)
+        mappings.push_back(*dynamicBoxes[firstHandle + i].mapping);
+
+    return mappings;
+}
+
+static const uint32_t DynamicStateMagic = 0x53445042; // "BPDS"
+static const uint32_t DynamicStateVersion = 2;
+
+// smallest encoding of a bin: its mapping count and an empty root node
+static const size_t MinBinStateSize = sizeof(int32_t) + sizeof(uint8_t) + sizeof(Rect);
+
+std::vector<uint8_t> BinPacker::SaveDynamicState() const
+{
+    if (!dynamicPacking)
+        throw std::runtime_error("'StartDynamicPacking' must be called first");
+
+    std::vector<uint8_t> data;
+    BinaryWriter writer(data);
+
+    writer.Write<uint32_t>(DynamicStateMagic);
+    writer.Write<uint32_t>(DynamicStateVersion);
+    writer.Write<int32_t>(binSize);
+    writer.Write<int32_t>(boxPadding);
+    writer.Write<uint8_t>(allowRotation);
+    writer.Write<int32_t>((int32_t)dynamicBoxes.size());
+    writer.Write<int32_t>((int32_t)bins.size());
+
+    // one bit per handle marks the live ones, so the handle table
+    // can't claim more space than the state actually occupies
+    for (size_t i = 0; i < dynamicBoxes.size(); i += 8)
+    {
+        uint8_t live = 0;
+
+        for (size_t j = i; j < std::min(i + 8, dynamicBoxes.size()); ++j)
+        {
+            if (dynamicBoxes[j].bin >= 0)
+                live |= (uint8_t)(1 << (j - i));
+        }
+
+        writer.Write<uint8_t>(live);
+    }
+
+    for (auto& bin : bins)
+    {
+        writer.Write<int32_t>((int32_t)bin.mappings.size());
+
+        for (auto& mapping : bin.mappings)
+        {
+            writer.Write<int32_t>(mapping.handle);
+            writer.Write<int32_t>(mapping.inputSize.x);
+            writer.Write<int32_t>(mapping.inputSize.y);
+            writer.Write<Rect>(mapping.mappedRect);
+            writer.Write<uint8_t>(mapping.rotated);
+        }
+
+        WriteTree(writer, bin.root.get());
+    }
+
+    return data;
+}
+
+void BinPacker::LoadDynamicState(const void* data, size_t size)
+{
+    // the trace would have to embed the state to be replayed
+    if (recorder)
+        throw std::runtime_error("dynamic packing state can't be loaded while recording");
+
+    BinaryReader reader(data, size);
+
+    if (reader.Read<uint32_t>() != DynamicStateMagic)
+        throw std::runtime_error("invalid dynamic packing state");
+
+    if (reader.Read<uint32_t>() != DynamicStateVersion)
+        throw std::runtime_error("unsupported dynamic packing state version");
+
+    int newBinSize = reader.Read<int32_t>();
+    int newBoxPadding = reader.Read<int32_t>();
+    bool newAllowRotation = reader.Read<uint8_t>() != 0;
+    int handleCount = reader.Read<int32_t>();
+    int binCount = reader.Read<int32_t>();
+
+    if (newBinSize <= 0 || handleCount < 0 || binCount <= 0)
+        throw std::runtime_error("invalid dynamic packing state");
+
+    // check the counts against the payload before allocating anything for them
+    size_t liveBytes = ((size_t)handleCount + 7) / 8;
+    if (liveBytes > reader.GetRemaining() ||
+        (size_t)binCount > (reader.GetRemaining() - liveBytes) / MinBinStateSize)
+        throw std::runtime_error("invalid dynamic packing state");
+
+    std::vector<uint8_t> live(handleCount);
+    for (int i = 0; i < handleCount; i += 8)
+    {
+        uint8_t bits = reader.Read<uint8_t>();
+
+        for (int j = i; j < std::min(i + 8, handleCount); ++j)
+            live[j] = (bits >> (j - i)) & 1;
+    }
+
+    // every branch on a path holds a different box, and with boxes at least one unit
+    // in size, each one shrinks the remaining width plus height, so a deeper tree
+    // couldn't have been built by the packer and would overflow the stack in Node
+    int maxDepth = (int)std::min((int64_t)handleCount, (int64_t)newBinSize * 2);
+
+    std::vector<DynamicBox> newBoxes(handleCount);
+    std::vector<uint8_t> referenced(handleCount);
+    std::vector<Bin> newBins;
+    newBins.reserve(binCount);
+
+    for (int b = 0; b < binCount; ++b)
+    {
+        newBins.emplace_back(Size(newBinSize, newBinSize));
+        auto& bin = newBins.back();
+
+        int mappingCount = reader.Read<int32_t>();
+        if (mappingCount < 0)
+            throw std::runtime_error("invalid dynamic packing state");
+
+        for (int i = 0; i < mappingCount; ++i)
+        {
+            RectMapping mapping;
+            mapping.inputIndex = b;
+            mapping.handle = reader.Read<int32_t>();
+            mapping.inputSize.x = reader.Read<int32_t>();
+            mapping.inputSize.y = reader.Read<int32_t>();
+            mapping.mappedRect = reader.Read<Rect>();
+            mapping.rotated = reader.Read<uint8_t>() != 0;
+
+            if (mapping.handle < 0 || mapping.handle >= handleCount ||
+                !live[mapping.handle] || newBoxes[mapping.handle].bin >= 0)
+                throw std::runtime_error("invalid box handle in dynamic packing state");
+
+            bin.mappings.push_back(mapping);
+            newBoxes[mapping.handle].bin = b;
+            newBoxes[mapping.handle].mapping = std::prev(bin.mappings.end());
+        }
+
+        bin.root = ReadTree(reader, newBoxes, referenced, b, maxDepth);
+
+        // every box must be held by exactly one node, and that node must be the
+        // one Node::Remove will find, or freeing the box would leave a dangling pMapping
+        for (auto& mapping : bin.mappings)
+        {
+            if (!referenced[mapping.handle])
+                throw std::runtime_error("unreferenced box in dynamic packing state");
+
+            const Node* node = bin.root.get();
+            int x = mapping.mappedRect.x;
+            int y = mapping.mappedRect.y;
+
+            while (node->pMapping != &mapping)
+            {
+                if (node->type != NodeType::Branch)
+                    throw std::runtime_error("unreachable box in dynamic packing state");
+
+                node = node->left->Contains(x, y) ? node->left.get() : node->right.get();
+            }
+        }
+    }
+
+    for (int i = 0; i < handleCount; ++i)
+    {
+        if (live[i] && newBoxes[i].bin < 0)
+            throw std::runtime_error("missing box in dynamic packing state");
+    }
+
+    if (!reader.AtEnd())
+        throw std::runtime_error("invalid dynamic packing state");
+
+    dynamicPacking = true;
+    binSize = newBinSize;
+    boxPadding = newBoxPadding;
+    allowRotation = newAllowRotation;
+    inTransaction = false;
+    bins.swap(newBins);
+    dynamicBoxes.swap(newBoxes);
+}
+
+void BinPacker::WriteTree(BinaryWriter& writer, const Node* root) const
+{
+    // nodes are written in preorder, using an explicit stack since trees can be very deep
+    std::vector<const Node*> stack;
+    stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const Node* node = stack.back();
+        stack.pop_back();
+
+        writer.Write<uint8_t>((uint8_t)node->type);
+        writer.Write<Rect>(node->rect);
+
+        if (node->type == NodeType::Empty)
+            continue;
+
+        writer.Write<int32_t>(node->pMapping ? node->pMapping->handle : -1);
+
+        if (node->type == NodeType::Branch)
+        {
+            stack.push_back(node->right.get());
+            stack.push_back(node->left.get());
+        }
+    }
+}
+
+NodePtr BinPacker::ReadTree(BinaryReader& reader, std::vector<DynamicBox>& boxes, std::vector<uint8_t>& referenced, int binIndex, int maxDepth)
+{
+    NodePtr root;
+    std::vector<std::pair<NodePtr*, int>> stack;
+    stack.emplace_back(&root, 0);
+
+    while (!stack.empty())
+    {
+        NodePtr& node = *stack.back().first;
+        int depth = stack.back().second;
+        stack.pop_back();
+
+        if (depth > maxDepth)
+            throw std::runtime_error("invalid dynamic packing state");
+
+        node = nodeAllocator->GetNode();
+
+        uint8_t type = reader.Read<uint8_t>();
+        if (type > (uint8_t)NodeType::Leaf)
+            throw std::runtime_error("invalid dynamic packing state");
+
+        node->Reset(reader.Read<Rect>());
+        node->type = (NodeType)type;
+
+        if (node->type == NodeType::Empty)
+            continue;
+
+        int handle = reader.Read<int32_t>();
+        if (handle >= 0)
+        {
+            if (handle >= (int)boxes.size() || boxes[handle].bin != binIndex || referenced[handle])
+                throw std::runtime_error("invalid box handle in dynamic packing state");
+
+            referenced[handle] = 1;
+            node->pMapping = &*boxes[handle].mapping;
+        }
+        else if (node->type == NodeType::Leaf)
+        {
+            throw std::runtime_error("invalid dynamic packing state");
+        }
+
+        if (node->type == NodeType::Branch)
+        {
+            stack.emplace_back(&node->right, depth + 1);
+            stack.emplace_back(&node->left, depth + 1);
+        }
+    }
+
+    return root;
+}
+
+size_t BinPacker::CountTreeNodes(const Node* root)
+{
+    size_t count = 0;
+    std::vector<const Node*> stack;
+
+    if (root)
+        stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        const Node* node = stack.back();
+        stack.pop_back();
+        ++count;
+
+        if (node->left) stack.push_back(node->left.get());
+        if (node->right) stack.push_back(node->right.get());
+    }
+
+    return count;
+}
+
+void BinPacker::ReleaseSpareNodes(Node* root)
+{
+    std::vector<Node*> stack;
+
+    if (root)
+        stack.push_back(root);
+
+    while (!stack.empty())
+    {
+        Node* node = stack.back();
+        stack.pop_back();
+
+        // only branches use their children, the others keep them to avoid reallocating them
+        if (node->type == NodeType::Branch)
+        {
+            stack.push_back(node->left.get());
+            stack.push_back(node->right.get());
+        }
+        else
+        {
+            node->left.reset();
+            node->right.reset();
+        }
+    }
+}
+
+MemoryUsage BinPacker::GetMemoryUsage() const
+{
+    // a list node holds the value and two links
+    constexpr size_t MappingNodeSize = sizeof(RectMapping) + 2 * sizeof(void*);
+
+    MemoryUsage usage;
+    usage.nodePool = nodeAllocator->GetPoolBytes();
+    usage.bins = bins.capacity() * sizeof(Bin);
+
+    for (auto& bin : bins)
+    {
+        usage.treeNodes += CountTreeNodes(bin.root.get()) * sizeof(Node);
+        usage.mappings += bin.mappings.size() * MappingNodeSize;
+        usage.bins += bin.dirtyRegion.GetRects().capacity() * sizeof(Rect);
+    }
+
+    usage.dynamicBoxes = dynamicBoxes.capacity() * sizeof(DynamicBox);
+
+    for (auto& sorted : sortedInput)
+        usage.scratch += sorted.capacity() * sizeof(RectMapping);
+
+    usage.scratch += input.capacity() * sizeof(RectMapping);
+    usage.scratch += overflow.capacity() * sizeof(RectMapping);
+    usage.scratch += binSizes.capacity() * sizeof(Size);
+    usage.scratch += stagedBoxes.capacity() * sizeof(Size);
+    return usage;
+}
+
+void BinPacker::ShrinkToFit()
+{
+    for (auto& sorted : sortedInput)
+        std::vector<RectMapping>().swap(sorted);
+
+    std::vector<RectMapping>().swap(input);
+    std::vector<RectMapping>().swap(overflow);
+    std::vector<Size>().swap(binSizes);
+
+    if (!inTransaction)
+        std::vector<Size>().swap(stagedBoxes);
+
+    for (auto& bin : bins)
+        ReleaseSpareNodes(bin.root.get());
+
+    bins.shrink_to_fit();
+    dynamicBoxes.shrink_to_fit();
+    nodeAllocator->ShrinkToFit();
+}
+
+PackingMetrics BinPacker::GetMetrics() const
+{
+    return ComputeMetrics(bins);
+}
+
+const PackStats& BinPacker::GetBinStats(int binIndex) const
+{
+    if (binIndex < 0 || binIndex >= (int)bins.size())
+        throw std::runtime_error("invalid bin index");
+
+    return bins[binIndex].stats;
+}
+
+std::vector<Rect> BinPacker::TakeDirtyRects(int binIndex)
+{
+    if (binIndex < 0 || binIndex >= (int)bins.size())
+        throw std::runtime_error("invalid bin index");
+
+    return bins[binIndex].dirtyRegion.Take();
+}
+
+void BinPacker::AddDynamicBin()
+{
+    Bin bin({ binSize, binSize });
+    {
+        StatsScope scope(bin.stats);
+        bin.root = nodeAllocator->GetNode();
+    }
+    bin.root->Reset(Rect(0, 0, binSize, binSize));
+    bins.push_back(std::move(bin));
+}
+
+bool BinPacker::InsertDynamicBox(int binIndex, const Size& box, int handle)
+{
+    auto& bin = bins[binIndex];
+    auto mapping = RectMapping{ box, binIndex };
+    mapping.handle = handle;
+
+    StatsScope scope(bin.stats);
+
+    Node* insertedNode = bin.root->Insert(mapping, boxPadding, allowRotation);
+    if (!insertedNode) {
+        BINPACKING_STAT(failedInserts);
+        return false;
+    }
+
+    bin.mappings.push_back(mapping);
+    insertedNode->pMapping = &bin.mappings.back();
+    bin.dirtyRegion.Add(mapping.mappedRect);
+
+    auto& entry = dynamicBoxes[handle];
+    entry.bin = binIndex;
+    entry.mapping = std::prev(bin.mappings.end());
+    return true;
+}
+
+void BinPacker::RemoveDynamicBox(const DynamicBox& entry)
+{
+    auto& bin = bins[entry.bin];
+
+    // the tree is searched by position, so a box it can't find means the state is corrupt
+    if (!bin.root->Remove(&*entry.mapping))
+        throw std::runtime_error("box not found in its bin");
+
+    bin.dirtyRegion.Add(entry.mapping->mappedRect);
+    bin.mappings.erase(entry.mapping);
+}
+
+}
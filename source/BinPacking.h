@@ -0,0 +1,233 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <array>
+#include <algorithm>
+#include <list>
+#include <deque>
+#include <chrono>
+#include <Size.h>
+#include <Rect.h>
+#include <Bin.h>
+#include <BoxMove.h>
+#include <BinaryStream.h>
+#include <Node.h>
+#include <NodeAllocator.h>
+#include <PackStats.h>
+#include <Trace.h>
+#include <PackingMetrics.h>
+#include <DynamicTrace.h>
+#include <MemoryUsage.h>
+
+namespace binpacking
+{
+
+class BinPacker
+{
+    static bool IsAreaDescending(const RectMapping& a, const RectMapping& b) {
+        return a.inputSize.area() > b.inputSize.area();
+    }
+
+    static bool IsPerimeterDescending(const RectMapping& a, const RectMapping& b) {
+        return a.inputSize.perimeter() > b.inputSize.perimeter();
+    }
+
+    static bool IsMaxSideLengthDescending(const RectMapping& a, const RectMapping& b) {
+        return std::max(a.inputSize.x, a.inputSize.y) > std::max(b.inputSize.x, b.inputSize.y);
+    }
+
+    static bool IsMaxWidthDescending(const RectMapping& a, const RectMapping& b) {
+        return a.inputSize.x > b.inputSize.x;
+    }
+
+    static bool IsMaxHeightDescending(const RectMapping& a, const RectMapping& b) {
+        return a.inputSize.y > b.inputSize.y;
+    }
+
+    typedef bool (*BinComparison)(const RectMapping& a, const RectMapping& b);
+
+    constexpr static int NumBinComparison = 5;
+
+    std::array<BinComparison, NumBinComparison> binComparisons {
+        IsAreaDescending,
+        IsPerimeterDescending,
+        IsMaxSideLengthDescending,
+        IsMaxWidthDescending,
+        IsMaxHeightDescending
+    };
+
+    std::array<std::vector<RectMapping>, NumBinComparison> sortedInput;
+    std::vector<RectMapping> input;
+    std::vector<RectMapping> overflow;
+    std::vector<Size> binSizes;
+    std::vector<Bin> bins;
+    
+    std::shared_ptr<NodeAllocator> nodeAllocator = std::make_shared<NodeAllocator>();
+
+    struct DynamicBox
+    {
+        int bin = -1; // -1 if the box was freed
+        std::list<RectMapping>::iterator mapping;
+    };
+
+    bool dynamicPacking = false;
+    int binSize = 0;
+    int boxPadding = 0;
+    bool allowRotation = true;
+    std::vector<DynamicBox> dynamicBoxes;
+    std::vector<Size> stagedBoxes;
+    bool inTransaction = false;
+    bool transactionSingleBin = false;
+    PackStats stats;
+    DynamicTraceRecorder* recorder = nullptr;
+
+public:
+    // Which sort orders and bin sizes won in static packing, over the packer's lifetime.
+    // Sort orders are indices into binComparisons: area, perimeter, max side, width, height.
+    // Bin sizes are indices into the candidate list, which goes from maxSize x maxSize
+    // down, three shapes (square, wide, tall) per halving.
+    struct HeuristicStats
+    {
+        uint64_t bins = 0;
+        uint64_t skippedOrders = 0; // sort orders left out by adaptive ordering
+        std::array<uint64_t, NumBinComparison> orderWins {};
+        std::vector<uint64_t> sizeWins;
+    };
+
+private:
+    HeuristicStats heuristicStats;
+    bool adaptiveOrdering = false;
+    int adaptiveWindow = 32;
+    int adaptiveExploreInterval = 8;
+    std::deque<int> recentWinners;
+    bool keepNodeTrees = false;
+
+    void SelectComparisons(std::array<bool, NumBinComparison>& enabled);
+    void RecordWin(int orderIndex, int sizeIndex);
+
+    Bin PackBin(
+        std::vector<RectMapping>& input,
+        const std::vector<Size>& binSizes,
+        int padding, bool allowRotation,
+        std::vector<RectMapping>& overflow);
+
+    void AddDynamicBin();
+    bool InsertDynamicBox(int binIndex, const Size& box, int handle);
+    void RemoveDynamicBox(const DynamicBox& entry);
+    void SortDynamicInput(const std::vector<Size>& boxes, int orderIndex = 0);
+    bool InsertDynamicBoxes(int binIndex, int firstHandle);
+    void PlaceDynamicInput(int firstHandle);
+    void RemoveDynamicInput(int firstHandle);
+    std::vector<RectMapping> GetDynamicMappings(int firstHandle, int count);
+    void WriteTree(BinaryWriter& writer, const Node* root) const;
+    NodePtr ReadTree(BinaryReader& reader, std::vector<DynamicBox>& boxes, std::vector<uint8_t>& referenced, int binIndex, int maxDepth);
+    static size_t CountTreeNodes(const Node* root);
+    static void ReleaseSpareNodes(Node* root);
+
+public:
+    void PackBoxes(
+        const std::vector<Size>& boxes,
+        int maxSize,
+        int padding,
+        bool allowRotation = true);
+
+    // Boxes packed dynamically must have a positive width and height, unlike in PackBoxes,
+    // since boxes without area can't be found in the node tree to be freed.
+    void StartDynamicPacking(int binSize, int boxPadding, bool allowRotation);
+    RectMapping PackBox(const Size& box);
+    void FreeBox(int handle);
+
+    // Packs several boxes at once and returns their mappings in input order.
+    // Boxes are placed in area order, unless that needs new bins. Then the other sort orders
+    // are tried, and the one that adds the fewest bins is kept, preferring the one that leaves
+    // the most room in them. Adaptive ordering doesn't apply here, and the work of discarded
+    // orders isn't counted in the stats.
+    std::vector<RectMapping> PackBoxBatch(const std::vector<Size>& boxes);
+
+    // Boxes staged in a transaction are packed all at once when it's committed, or not at all.
+    // If 'singleBin' is true, the boxes must all fit in one bin, or the commit fails and
+    // nothing is packed. Mappings are returned in the order the boxes were staged.
+    void BeginTransaction(bool singleBin = false);
+    int StageBox(const Size& box);
+    bool CommitTransaction(std::vector<RectMapping>& mappings);
+    void RollbackTransaction();
+
+    // Moves boxes out of the least occupied bins and into fuller ones to consolidate free space.
+    // Stops after 'maxMoves' moves, or once 'timeLimit' has elapsed if it's non-zero.
+    // Bins that become empty are kept so that bin indices stay valid, except at the end of the list.
+    // The returned moves must be applied in order, since a later move may reuse space vacated by an earlier one.
+    std::vector<BoxMove> Compact(
+        int maxMoves,
+        std::chrono::microseconds timeLimit = std::chrono::microseconds::zero());
+
+    // Serializes the full dynamic packing state, including node trees and box handles,
+    // so that it can be restored later without packing the boxes again.
+    std::vector<uint8_t> SaveDynamicState() const;
+    void LoadDynamicState(const void* data, size_t size);
+
+    // Returns the areas of a bin that changed since the last call, and clears them.
+    // Boxes that were packed, freed, or moved by 'Compact' are reported.
+    std::vector<Rect> TakeDirtyRects(int binIndex);
+
+    // Records the dynamic packing calls that change the layout into 'recorder', which
+    // must outlive the packer or be detached by passing null. Recording must start before
+    // StartDynamicPacking, and LoadDynamicState can't be called while it's on.
+    void SetRecorder(DynamicTraceRecorder* recorder);
+
+    // When enabled, PackBoxes only tries the sort orders that won one of the last 'window' bins,
+    // except for every 'exploreInterval'th bin, where all of them are tried again.
+    void SetAdaptiveOrdering(bool enabled, int window = 32, int exploreInterval = 8);
+
+    // Settings that change the results of PackBoxes, other than its arguments.
+    struct Options
+    {
+        bool adaptiveOrdering = false;
+        int adaptiveWindow = 32;
+        int adaptiveExploreInterval = 8;
+    };
+
+    Options GetOptions() const;
+
+    const HeuristicStats& GetHeuristicStats() const {
+        return heuristicStats;
+    }
+
+    void ResetHeuristicStats();
+
+    // Reports the memory held by the packer, by category.
+    MemoryUsage GetMemoryUsage() const;
+
+    // Releases scratch buffers, pooled nodes, and spare subtrees that node trees keep for reuse.
+    // Results and dynamic packing state are kept.
+    void ShrinkToFit();
+
+    // When enabled, bins packed by PackBoxes keep their node tree, so that GetMetrics can
+    // report padding, unusable space and fragmentation for them. Off by default to save memory.
+    void SetKeepNodeTrees(bool enabled) {
+        keepNodeTrees = enabled;
+    }
+
+    // Occupancy, wasted space and fragmentation of the current bins.
+    // Static bins only report used and free area unless SetKeepNodeTrees was enabled when they were packed.
+    PackingMetrics GetMetrics() const;
+
+    // Counters of the last call to PackBoxes, PackBox, PackBoxBatch, CommitTransaction or Compact.
+    // Always zero unless BINPACKING_STATS is enabled.
+    const PackStats& GetStats() const {
+        return stats;
+    }
+
+    // Counters of a single bin. Static bins count the work done to pack them,
+    // dynamic bins count every insert attempted on them since they were added.
+    const PackStats& GetBinStats(int binIndex) const;
+
+    const std::vector<Bin>& GetBins() const {
+        return bins;
+    }
+};
+
+}
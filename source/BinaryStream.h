@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <vector>
+#include <stdexcept>
+#include <type_traits>
+
+namespace binpacking
+{
+
+// Appends plain values to a byte buffer in native (little-endian) byte order.
+class BinaryWriter
+{
+    std::vector<uint8_t>& buffer;
+
+public:
+    BinaryWriter(std::vector<uint8_t>& buffer)
+        : buffer(buffer) {}
+
+    template<class T>
+    void Write(const T& value)
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+        size_t pos = buffer.size();
+        buffer.resize(pos + sizeof(T));
+        memcpy(buffer.data() + pos, &value, sizeof(T));
+    }
+};
+
+// Reads values written by BinaryWriter, throwing if the data runs out.
+class BinaryReader
+{
+    const uint8_t* data;
+    size_t size;
+    size_t pos = 0;
+
+public:
+    BinaryReader(const void* data, size_t size)
+        : data((const uint8_t*)data), size(size) {}
+
+    template<class T>
+    T Read()
+    {
+        static_assert(std::is_trivially_copyable<T>::value, "T must be trivially copyable");
+
+        if (size - pos < sizeof(T))
+            throw std::runtime_error("unexpected end of data");
+
+        T value;
+        memcpy(&value, data + pos, sizeof(T));
+        pos += sizeof(T);
+        return value;
+    }
+
+    bool AtEnd() const {
+        return pos == size;
+    }
+
+    size_t GetRemaining() const {
+        return size - pos;
+    }
+};
+
+}
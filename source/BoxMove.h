@@ -0,0 +1,25 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <Rect.h>
+
+namespace binpacking
+{
+
+// Relocation of a dynamically packed box, as reported by BinPacker::Compact.
+// The contents of 'oldRect' in bin 'oldBin' should be copied to 'newRect' in bin 'newBin'.
+struct BoxMove
+{
+    int handle = -1;
+    int oldBin = 0;
+    Rect oldRect;
+    bool oldRotated = false;
+    int newBin = 0;
+    Rect newRect;
+    bool newRotated = false;
+};
+
+}
@@ -0,0 +1,245 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Compositor.h>
+#include <ParallelFor.h>
+#include <Simd.h>
+#include <algorithm>
+#include <stdexcept>
+#include <cstring>
+
+namespace binpacking
+{
+
+// rows of a mapping copied as one unit of work
+static const int BandRows = 64;
+
+// side length of the tiles that rotated copies are done in, so
+// that both the source and destination rows stay in cache
+static const int TileSize = 32;
+
+static void CopyRows(const ImageView& src, Image& dest, int x, int y, int rowBegin, int rowEnd)
+{
+    size_t rowBytes = (size_t)src.width * src.channels;
+
+    for (int row = rowBegin; row < rowEnd; ++row)
+        memcpy(dest.GetRow(y + row) + x * dest.GetChannels(), src.GetRow(row), rowBytes);
+}
+
+// dest(dx, dy) = src(dy, src.height - 1 - dx)
+static void CopyRotated(const ImageView& src, Image& dest, int x, int y, int rowBegin, int rowEnd)
+{
+    const int channels = src.channels;
+    const int destWidth = src.height;
+
+    for (int ty = rowBegin; ty < rowEnd; ty += TileSize)
+    {
+        int tyEnd = std::min(ty + TileSize, rowEnd);
+
+        for (int tx = 0; tx < destWidth; tx += TileSize)
+        {
+            int txEnd = std::min(tx + TileSize, destWidth);
+            int dy = ty;
+
+#if BINPACKING_SSE2
+            if (channels == 4)
+            {
+                // transpose 4x4 pixel blocks in registers
+                for ( ; dy + 4 <= tyEnd; dy += 4)
+                {
+                    int dx = tx;
+
+                    for ( ; dx + 4 <= txEnd; dx += 4)
+                    {
+                        int sy = src.height - 1 - dx;
+                        __m128i r0 = _mm_loadu_si128((const __m128i*)(src.GetRow(sy - 0) + dy * 4));
+                        __m128i r1 = _mm_loadu_si128((const __m128i*)(src.GetRow(sy - 1) + dy * 4));
+                        __m128i r2 = _mm_loadu_si128((const __m128i*)(src.GetRow(sy - 2) + dy * 4));
+                        __m128i r3 = _mm_loadu_si128((const __m128i*)(src.GetRow(sy - 3) + dy * 4));
+
+                        __m128i t0 = _mm_unpacklo_epi32(r0, r1);
+                        __m128i t1 = _mm_unpacklo_epi32(r2, r3);
+                        __m128i t2 = _mm_unpackhi_epi32(r0, r1);
+                        __m128i t3 = _mm_unpackhi_epi32(r2, r3);
+
+                        uint8_t* out = dest.GetRow(y + dy) + (x + dx) * 4;
+                        size_t stride = dest.GetStride();
+
+                        _mm_storeu_si128((__m128i*)(out + stride * 0), _mm_unpacklo_epi64(t0, t1));
+                        _mm_storeu_si128((__m128i*)(out + stride * 1), _mm_unpackhi_epi64(t0, t1));
+                        _mm_storeu_si128((__m128i*)(out + stride * 2), _mm_unpacklo_epi64(t2, t3));
+                        _mm_storeu_si128((__m128i*)(out + stride * 3), _mm_unpackhi_epi64(t2, t3));
+                    }
+
+                    for ( ; dx < txEnd; ++dx)
+                    {
+                        const uint8_t* in = src.GetRow(src.height - 1 - dx) + dy * 4;
+
+                        for (int j = 0; j < 4; ++j)
+                            memcpy(dest.GetRow(y + dy + j) + (x + dx) * 4, in + j * 4, 4);
+                    }
+                }
+            }
+#endif
+
+            for ( ; dy < tyEnd; ++dy)
+            {
+                uint8_t* out = dest.GetRow(y + dy) + (x + tx) * channels;
+
+                for (int dx = tx; dx < txEnd; ++dx, out += channels)
+                {
+                    const uint8_t* in = src.GetRow(src.height - 1 - dx) + dy * channels;
+
+                    if (channels == 4)
+                        memcpy(out, in, 4);
+                    else
+                        *out = *in;
+                }
+            }
+        }
+    }
+}
+
+static void FillPixels(uint8_t* dest, const uint8_t* pixel, int count, int channels)
+{
+    if (channels == 1)
+    {
+        memset(dest, *pixel, count);
+        return;
+    }
+
+    int i = 0;
+
+#if BINPACKING_SSE2
+    int value;
+    memcpy(&value, pixel, 4);
+    __m128i v = _mm_set1_epi32(value);
+
+    for ( ; i + 4 <= count; i += 4)
+        _mm_storeu_si128((__m128i*)(dest + i * 4), v);
+#endif
+
+    for ( ; i < count; ++i)
+        memcpy(dest + i * 4, pixel, 4);
+}
+
+static void ExtrudeMapping(Image& page, const Rect& rc, int width)
+{
+    if (rc.w <= 0 || rc.h <= 0)
+        return;
+
+    const int channels = page.GetChannels();
+
+    int left = std::min(width, rc.x);
+    int right = std::min(width, page.GetWidth() - (rc.x + rc.w));
+    int top = std::min(width, rc.y);
+    int bottom = std::min(width, page.GetHeight() - (rc.y + rc.h));
+
+    for (int y = rc.y; y < rc.y + rc.h; ++y)
+    {
+        uint8_t* row = page.GetRow(y);
+        uint8_t* first = row + rc.x * channels;
+        uint8_t* last = row + (rc.x + rc.w - 1) * channels;
+
+        FillPixels(first - left * channels, first, left, channels);
+        FillPixels(last + channels, last, right, channels);
+    }
+
+    // the first and last rows now include the corners
+    size_t offset = (size_t)(rc.x - left) * channels;
+    size_t rowBytes = (size_t)(left + rc.w + right) * channels;
+
+    const uint8_t* firstRow = page.GetRow(rc.y) + offset;
+    const uint8_t* lastRow = page.GetRow(rc.y + rc.h - 1) + offset;
+
+    for (int i = 1; i <= top; ++i)
+        memcpy(page.GetRow(rc.y - i) + offset, firstRow, rowBytes);
+
+    for (int i = 1; i <= bottom; ++i)
+        memcpy(page.GetRow(rc.y + rc.h - 1 + i) + offset, lastRow, rowBytes);
+}
+
+void ExtrudeEdges(Image& page, const Bin& bin, int width, int padding, int threadCount)
+{
+    if (width <= 0)
+        return;
+
+    if (width > padding / 2)
+        throw std::runtime_error("extrusion width must be at most half the padding");
+
+    if (page.GetWidth() != bin.size.x || page.GetHeight() != bin.size.y)
+        throw std::runtime_error("page size doesn't match bin");
+
+    std::vector<const RectMapping*> mappings;
+    mappings.reserve(bin.mappings.size());
+
+    for (auto& mapping : bin.mappings)
+        mappings.push_back(&mapping);
+
+    ParallelFor((int)mappings.size(), threadCount, [&](int i) {
+        ExtrudeMapping(page, mappings[i]->mappedRect, width);
+    });
+}
+
+void CopyImage(const ImageView& src, Image& dest, int x, int y, bool rotated, int rowBegin, int rowEnd)
+{
+    if (rotated)
+        CopyRotated(src, dest, x, y, rowBegin, rowEnd);
+    else
+        CopyRows(src, dest, x, y, rowBegin, rowEnd);
+}
+
+Image ComposeBin(const Bin& bin, const std::vector<ImageView>& inputs, int threadCount)
+{
+    struct Band
+    {
+        const RectMapping* mapping;
+        int rowBegin;
+        int rowEnd;
+    };
+
+    int channels = 0;
+    std::vector<Band> bands;
+
+    for (auto& mapping : bin.mappings)
+    {
+        if (mapping.inputIndex < 0 || mapping.inputIndex >= (int)inputs.size())
+            throw std::runtime_error("missing input image for mapping");
+
+        auto& input = inputs[mapping.inputIndex];
+        auto& rc = mapping.mappedRect;
+
+        if (input.channels != 1 && input.channels != 4)
+            throw std::runtime_error("input images must have 1 or 4 channels");
+
+        if (channels && input.channels != channels)
+            throw std::runtime_error("input images must all have the same number of channels");
+
+        if (input.width != mapping.inputSize.x || input.height != mapping.inputSize.y)
+            throw std::runtime_error("input image size doesn't match mapping");
+
+        if (rc.x < 0 || rc.y < 0 || rc.x + rc.w > bin.size.x || rc.y + rc.h > bin.size.y)
+            throw std::runtime_error("mapping is outside of bin");
+
+        channels = input.channels;
+
+        for (int row = 0; row < rc.h; row += BandRows)
+            bands.push_back({ &mapping, row, std::min(row + BandRows, rc.h) });
+    }
+
+    Image page(bin.size.x, bin.size.y, channels ? channels : 4);
+
+    ParallelFor((int)bands.size(), threadCount, [&](int i) {
+        auto& band = bands[i];
+        auto& mapping = *band.mapping;
+        CopyImage(inputs[mapping.inputIndex], page,
+            mapping.mappedRect.x, mapping.mappedRect.y,
+            mapping.rotated, band.rowBegin, band.rowEnd);
+    });
+
+    return page;
+}
+
+}
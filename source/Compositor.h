@@ -0,0 +1,31 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <Bin.h>
+#include <Image.h>
+
+namespace binpacking
+{
+
+// Copies each input image into its mapped rectangle of the bin's page.
+// 'inputs' is indexed by RectMapping::inputIndex, and every input must have the
+// same channel count. Rotated mappings hold the input turned 90 degrees clockwise.
+// Mappings are split into bands of rows that are copied on up to 'threadCount' threads.
+Image ComposeBin(const Bin& bin, const std::vector<ImageView>& inputs, int threadCount = 0);
+
+// Replicates the border pixels of each mapping outward by 'width' pixels, so that
+// filtering near the edge of a mapping doesn't sample its neighbors. This works on
+// the composed page, so rotated mappings are extruded along their rotated edges.
+// 'padding' is the padding the bin was packed with, and 'width' can be at most half
+// of it, since wider borders would overwrite neighboring mappings.
+void ExtrudeEdges(Image& page, const Bin& bin, int width, int padding, int threadCount = 0);
+
+// Copies 'src' into 'dest' at (x, y), turned 90 degrees clockwise if 'rotated' is set.
+// Only rows [rowBegin, rowEnd) of the destination rectangle are written.
+void CopyImage(const ImageView& src, Image& dest, int x, int y, bool rotated, int rowBegin, int rowEnd);
+
+}
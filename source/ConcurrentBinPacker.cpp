@@ -0,0 +1,196 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <ConcurrentBinPacker.h>
+#include <Trace.h>
+#include <stdexcept>
+#include <thread>
+#include <cassert>
+
+namespace binpacking
+{
+
+void ConcurrentBinPacker::Page::LocateSlot(int index, int& chunk, int& offset)
+{
+    // chunk k holds FirstChunkSize << k slots
+    unsigned int n = (unsigned int)index / FirstChunkSize + 1;
+    chunk = 0;
+    while (n >>= 1)
+        ++chunk;
+
+    offset = index - FirstChunkSize * ((1 << chunk) - 1);
+}
+
+ConcurrentBinPacker::Page::~Page()
+{
+    for (auto chunk : chunks)
+        delete[] chunk;
+}
+
+RectMapping* ConcurrentBinPacker::Page::GetSlot(int index) const
+{
+    int chunk, offset;
+    LocateSlot(index, chunk, offset);
+    return &chunks[chunk][offset];
+}
+
+RectMapping* ConcurrentBinPacker::Page::AddSlot()
+{
+    int index = count.load(std::memory_order_relaxed);
+    int chunk, offset;
+    LocateSlot(index, chunk, offset);
+
+    if (chunk >= MaxChunks)
+        throw std::runtime_error("too many boxes in one bin");
+
+    if (!chunks[chunk])
+        chunks[chunk] = new RectMapping[FirstChunkSize << chunk];
+
+    return &chunks[chunk][offset];
+}
+
+ConcurrentBinPacker::ConcurrentBinPacker(int binSize, int boxPadding, bool allowRotation)
+    : binSize(binSize), boxPadding(boxPadding), allowRotation(allowRotation)
+{
+    AddPage();
+}
+
+RectMapping ConcurrentBinPacker::PackBox(const Size& box)
+{
+    if (box.x > binSize || box.y > binSize)
+        throw std::runtime_error("box is too large");
+
+    TraceScope trace("ConcurrentPackBox");
+
+    // spread threads over the bins so they don't all queue up on the first one
+    thread_local int threadHint = nextThreadHint.fetch_add(1, std::memory_order_relaxed);
+
+    RectMapping mapping;
+
+    while (true)
+    {
+        int pageCount;
+        {
+            std::shared_lock<std::shared_mutex> lock(pagesMutex);
+            pageCount = (int)pages.size();
+            int start = threadHint % pageCount;
+
+            // Bins that are busy are skipped rather than waited on. If none of the others
+            // have room, a new bin is added, instead of every thread queueing on full bins.
+            for (int i = 0; i < pageCount; ++i)
+            {
+                int pageIndex = (start + i) % pageCount;
+                auto& page = *pages[pageIndex];
+
+                std::unique_lock<std::mutex> pageLock(page.mutex, std::try_to_lock);
+                if (pageLock.owns_lock() && InsertIntoPage(page, pageIndex, box, mapping))
+                    return mapping;
+            }
+        }
+
+        std::unique_lock<std::shared_mutex> lock(pagesMutex);
+
+        // another thread may have added a bin in the meantime
+        if ((int)pages.size() == pageCount)
+        {
+            AddPage();
+
+            int pageIndex = (int)pages.size() - 1;
+            bool inserted = InsertIntoPage(*pages[pageIndex], pageIndex, box, mapping);
+            assert(inserted);
+            return mapping;
+        }
+    }
+}
+
+std::vector<Bin> ConcurrentBinPacker::GetBins() const
+{
+    // Handles are taken in order while a box is being published, so the snapshot is every box
+    // with a handle below the first one that hasn't been taken yet. Those boxes are all in bins
+    // that already exist, and the few that aren't published yet will be shortly.
+    int handleLimit = nextHandle.load(std::memory_order_acquire);
+
+    std::vector<const Page*> snapshotPages;
+    {
+        std::shared_lock<std::shared_mutex> lock(pagesMutex);
+        snapshotPages.reserve(pages.size());
+
+        for (auto& page : pages)
+            snapshotPages.push_back(page.get());
+    }
+
+    std::vector<Bin> bins;
+    bins.reserve(snapshotPages.size());
+
+    for (size_t p = 0; p < snapshotPages.size(); ++p)
+        bins.emplace_back(Size(binSize, binSize));
+
+    std::vector<int> copied(snapshotPages.size());
+    std::vector<bool> done(snapshotPages.size());
+    int total = 0;
+
+    while (true)
+    {
+        for (size_t p = 0; p < snapshotPages.size(); ++p)
+        {
+            auto& page = *snapshotPages[p];
+            int count = page.count.load(std::memory_order_acquire);
+
+            // slots are published in handle order within a bin
+            for ( ; !done[p] && copied[p] < count; ++copied[p])
+            {
+                const RectMapping& mapping = *page.GetSlot(copied[p]);
+
+                if (mapping.handle >= handleLimit) {
+                    done[p] = true;
+                    break;
+                }
+
+                bins[p].mappings.push_back(mapping);
+                ++total;
+            }
+        }
+
+        if (total == handleLimit)
+            break;
+
+        std::this_thread::yield();
+    }
+
+    return bins;
+}
+
+int ConcurrentBinPacker::GetBinCount() const
+{
+    std::shared_lock<std::shared_mutex> lock(pagesMutex);
+    return (int)pages.size();
+}
+
+bool ConcurrentBinPacker::InsertIntoPage(Page& page, int pageIndex, const Size& box, RectMapping& mapping)
+{
+    // the slot isn't visible until the count is raised, so it can be filled in place
+    RectMapping* slot = page.AddSlot();
+    *slot = RectMapping{ box, pageIndex };
+
+    if (!page.root->Insert(*slot, boxPadding, allowRotation))
+        return false;
+
+    // nothing can fail between taking a handle and publishing it, since 'GetBins' waits for it
+    slot->handle = nextHandle.fetch_add(1, std::memory_order_acq_rel);
+    page.count.fetch_add(1, std::memory_order_release);
+
+    mapping = *slot;
+    return true;
+}
+
+void ConcurrentBinPacker::AddPage()
+{
+    auto page = std::make_unique<Page>();
+    page->root = page->nodeAllocator->GetNode();
+    page->root->Reset(Rect(0, 0, binSize, binSize));
+    pages.push_back(std::move(page));
+}
+
+}
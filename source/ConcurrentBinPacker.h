@@ -0,0 +1,74 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <atomic>
+#include <Size.h>
+#include <Rect.h>
+#include <Bin.h>
+#include <Node.h>
+#include <NodeAllocator.h>
+
+namespace binpacking
+{
+
+// Dynamic packer that can be called from multiple threads at once.
+// Each bin has its own lock, and threads start searching at different bins,
+// so boxes going to different bins are packed in parallel.
+// Boxes can't be freed, so a bin's mappings only ever grow, which lets
+// 'GetBins' copy them without taking the bin locks.
+class ConcurrentBinPacker
+{
+    // mappings are stored in chunks of doubling size so that
+    // they never move, and readers can follow them without a lock
+    constexpr static int FirstChunkSize = 64;
+    constexpr static int MaxChunks = 26;
+
+    struct Page
+    {
+        std::mutex mutex;
+        std::shared_ptr<NodeAllocator> nodeAllocator = std::make_shared<NodeAllocator>();
+        NodePtr root;
+        RectMapping* chunks[MaxChunks] = {};
+        std::atomic<int> count { 0 };
+
+        ~Page();
+        static void LocateSlot(int index, int& chunk, int& offset);
+        RectMapping* GetSlot(int index) const;
+        RectMapping* AddSlot();
+    };
+
+    std::vector<std::unique_ptr<Page>> pages;
+    mutable std::shared_mutex pagesMutex;
+    std::atomic<int> nextHandle { 0 };
+    std::atomic<int> nextThreadHint { 0 };
+
+    int binSize = 0;
+    int boxPadding = 0;
+    bool allowRotation = true;
+
+    bool InsertIntoPage(Page& page, int pageIndex, const Size& box, RectMapping& mapping);
+    void AddPage();
+
+public:
+    ConcurrentBinPacker(int binSize, int boxPadding, bool allowRotation = true);
+
+    ConcurrentBinPacker(const ConcurrentBinPacker&) = delete;
+    ConcurrentBinPacker& operator=(const ConcurrentBinPacker&) = delete;
+
+    RectMapping PackBox(const Size& box);
+
+    // Returns a consistent snapshot of every bin's mappings: the boxes packed
+    // before one point in time during the call, and none packed after it.
+    // Packing threads aren't blocked, apart from briefly when adding a bin.
+    std::vector<Bin> GetBins() const;
+    int GetBinCount() const;
+};
+
+}
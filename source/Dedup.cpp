@@ -0,0 +1,137 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Dedup.h>
+#include <ParallelFor.h>
+#include <Hash.h>
+#include <unordered_map>
+#include <stdexcept>
+#include <cstring>
+
+namespace binpacking
+{
+
+uint64_t HashImage(const ImageView& image)
+{
+    Hasher hasher;
+    hasher.Add((uint64_t)image.width << 32 | (uint32_t)image.height);
+    hasher.Add((uint64_t)image.channels);
+
+    size_t rowBytes = (size_t)image.width * image.channels;
+
+    for (int y = 0; y < image.height; ++y)
+        hasher.AddBytes(image.GetRow(y), rowBytes);
+
+    return hasher.Finish();
+}
+
+static bool AreEqual(const ImageView& a, const ImageView& b)
+{
+    if (a.width != b.width || a.height != b.height || a.channels != b.channels)
+        return false;
+
+    size_t rowBytes = (size_t)a.width * a.channels;
+
+    for (int y = 0; y < a.height; ++y)
+    {
+        if (memcmp(a.GetRow(y), b.GetRow(y), rowBytes) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+DedupResult DeduplicateImages(const std::vector<ImageView>& images, int threadCount)
+{
+    std::vector<uint64_t> hashes(images.size());
+
+    ParallelFor((int)images.size(), threadCount, [&](int i) {
+        hashes[i] = HashImage(images[i]);
+    });
+
+    DedupResult result;
+    result.inputToUnique.resize(images.size());
+
+    // hash -> first unique image with that hash; collisions are chained through 'next'
+    std::unordered_map<uint64_t, int> firstWithHash;
+    std::vector<int> next;
+    firstWithHash.reserve(images.size());
+
+    for (int i = 0; i < (int)images.size(); ++i)
+    {
+        auto it = firstWithHash.find(hashes[i]);
+        int match = -1;
+
+        if (it != firstWithHash.end())
+        {
+            for (int u = it->second; u >= 0; u = next[u])
+            {
+                if (AreEqual(images[result.uniqueInputs[u]], images[i])) {
+                    match = u;
+                    break;
+                }
+            }
+        }
+
+        if (match < 0)
+        {
+            match = (int)result.uniqueInputs.size();
+            result.uniqueInputs.push_back(i);
+            result.uniqueSizes.push_back(images[i].size());
+
+            if (it != firstWithHash.end()) {
+                next.push_back(it->second);
+                it->second = match;
+            }
+            else {
+                next.push_back(-1);
+                firstWithHash.emplace(hashes[i], match);
+            }
+        }
+
+        result.inputToUnique[i] = match;
+    }
+
+    return result;
+}
+
+std::vector<Bin> ExpandDuplicates(const std::vector<Bin>& bins, const DedupResult& dedup)
+{
+    // inputs that share each unique image, chained in input order
+    std::vector<int> firstInput(dedup.uniqueInputs.size(), -1);
+    std::vector<int> nextInput(dedup.inputToUnique.size(), -1);
+
+    for (int i = (int)dedup.inputToUnique.size() - 1; i >= 0; --i)
+    {
+        int u = dedup.inputToUnique[i];
+        nextInput[i] = firstInput[u];
+        firstInput[u] = i;
+    }
+
+    std::vector<Bin> expanded;
+    expanded.reserve(bins.size());
+
+    for (auto& bin : bins)
+    {
+        expanded.emplace_back(bin.size);
+        auto& mappings = expanded.back().mappings;
+
+        for (auto& mapping : bin.mappings)
+        {
+            if (mapping.inputIndex < 0 || mapping.inputIndex >= (int)firstInput.size())
+                throw std::runtime_error("mapping doesn't refer to a unique image");
+
+            for (int i = firstInput[mapping.inputIndex]; i >= 0; i = nextInput[i])
+            {
+                mappings.push_back(mapping);
+                mappings.back().inputIndex = i;
+            }
+        }
+    }
+
+    return expanded;
+}
+
+}
@@ -0,0 +1,40 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <Size.h>
+#include <Bin.h>
+#include <Image.h>
+
+namespace binpacking
+{
+
+struct DedupResult
+{
+    // input index of the first occurrence of each distinct image
+    std::vector<int> uniqueInputs;
+
+    // for each input, its index in 'uniqueInputs'
+    std::vector<int> inputToUnique;
+
+    // sizes of the distinct images, to pass to BinPacker::PackBoxes
+    std::vector<Size> uniqueSizes;
+};
+
+// Hashes an image's size, channel count, and pixels. Row padding is ignored.
+uint64_t HashImage(const ImageView& image);
+
+// Groups pixel-identical images. Images are hashed in parallel, and
+// images with equal hashes are compared byte for byte before being merged.
+DedupResult DeduplicateImages(const std::vector<ImageView>& images, int threadCount = 0);
+
+// Takes bins packed from 'uniqueSizes' and returns bins whose mappings refer to the
+// original input indices. Every duplicate gets its own mapping with the same rectangle
+// as the image it duplicates, so every input index resolves to a mapping.
+std::vector<Bin> ExpandDuplicates(const std::vector<Bin>& bins, const DedupResult& dedup);
+
+}
@@ -0,0 +1,80 @@
+#include <DirtyRegion.h>
+#include <algorithm>
+#include <climits>
+
+namespace binpacking
+{
+
+void DirtyRegion::Add(const Rect& rc)
+{
+    if(rc.w <= 0 || rc.h <= 0)
+        return;
+
+    for(auto& r : rects)
+    {
+        if(Union(r, rc).area() == r.area())
+            return;
+    }
+
+    rects.push_back(rc);
+
+    while(rects.size() > 1)
+    {
+        int bestCost = INT_MAX;
+        size_t bestA = 0;
+        size_t bestB = 0;
+
+        for(size_t a = 0; a < rects.size(); ++a)
+        {
+            for(size_t b = a + 1; b < rects.size(); ++b)
+            {
+                int covered = rects[a].area() + rects[b].area() - Intersection(rects[a], rects[b]);
+                int cost = Union(rects[a], rects[b]).area() - covered;
+
+                if(cost < bestCost)
+                {
+                    bestCost = cost;
+                    bestA = a;
+                    bestB = b;
+                }
+            }
+        }
+
+        // merges that don't grow the region are always taken
+        if(bestCost > 0 && (int)rects.size() <= MaxRects)
+            break;
+
+        rects[bestA] = Union(rects[bestA], rects[bestB]);
+        rects.erase(rects.begin() + bestB);
+    }
+}
+
+void DirtyRegion::Clear()
+{
+    rects.clear();
+}
+
+std::vector<Rect> DirtyRegion::Take()
+{
+    std::vector<Rect> ret;
+    ret.swap(rects);
+    return ret;
+}
+
+Rect DirtyRegion::Union(const Rect& a, const Rect& b)
+{
+    int x0 = std::min(a.x, b.x);
+    int y0 = std::min(a.y, b.y);
+    int x1 = std::max(a.x + a.w, b.x + b.w);
+    int y1 = std::max(a.y + a.h, b.y + b.h);
+    return Rect(x0, y0, x1 - x0, y1 - y0);
+}
+
+int DirtyRegion::Intersection(const Rect& a, const Rect& b)
+{
+    int w = std::min(a.x + a.w, b.x + b.w) - std::max(a.x, b.x);
+    int h = std::min(a.y + a.h, b.y + b.h) - std::max(a.y, b.y);
+    return (w > 0 && h > 0) ? w * h : 0;
+}
+
+}
@@ -0,0 +1,39 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <Rect.h>
+
+namespace binpacking
+{
+
+// Accumulates changed areas of a bin as a small set of rectangles.
+// When the set grows past 'MaxRects', the two rectangles whose
+// bounding box adds the least unchanged area are merged.
+class DirtyRegion
+{
+    std::vector<Rect> rects;
+
+    static Rect Union(const Rect& a, const Rect& b);
+    static int Intersection(const Rect& a, const Rect& b);
+
+public:
+    constexpr static int MaxRects = 8;
+
+    void Add(const Rect& rc);
+    void Clear();
+    std::vector<Rect> Take();
+
+    bool IsEmpty() const {
+        return rects.empty();
+    }
+
+    const std::vector<Rect>& GetRects() const {
+        return rects;
+    }
+};
+
+}
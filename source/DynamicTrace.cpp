@@ -0,0 +1,163 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <DynamicTrace.h>
+#include <BinaryStream.h>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+namespace binpacking
+{
+
+DynamicTraceRecorder::DynamicTraceRecorder()
+{
+    BinaryWriter writer(data);
+    writer.Write(DynamicTraceMagic);
+    writer.Write(DynamicTraceVersion);
+}
+
+void DynamicTraceRecorder::RecordStart(int binSize, int boxPadding, bool allowRotation)
+{
+    BinaryWriter writer(data);
+    writer.Write(DynamicOpType::Start);
+    writer.Write((int32_t)binSize);
+    writer.Write((int32_t)boxPadding);
+    writer.Write((uint8_t)allowRotation);
+}
+
+void DynamicTraceRecorder::RecordPackBox(const Size& box, int handle)
+{
+    BinaryWriter writer(data);
+    writer.Write(DynamicOpType::PackBox);
+    writer.Write((int32_t)box.x);
+    writer.Write((int32_t)box.y);
+    writer.Write((int32_t)handle);
+}
+
+void DynamicTraceRecorder::RecordFreeBox(int handle)
+{
+    BinaryWriter writer(data);
+    writer.Write(DynamicOpType::FreeBox);
+    writer.Write((int32_t)handle);
+}
+
+void DynamicTraceRecorder::RecordPackBatch(const std::vector<Size>& boxes, int firstHandle)
+{
+    WriteBoxes(DynamicOpType::PackBatch, boxes, firstHandle);
+}
+
+void DynamicTraceRecorder::RecordPackSingleBin(const std::vector<Size>& boxes, int firstHandle)
+{
+    WriteBoxes(DynamicOpType::PackSingleBin, boxes, firstHandle);
+}
+
+void DynamicTraceRecorder::RecordCompact(int maxMoves, std::chrono::microseconds timeLimit)
+{
+    BinaryWriter writer(data);
+    writer.Write(DynamicOpType::Compact);
+    writer.Write((int32_t)maxMoves);
+    writer.Write((int64_t)timeLimit.count());
+}
+
+void DynamicTraceRecorder::WriteBoxes(DynamicOpType type, const std::vector<Size>& boxes, int firstHandle)
+{
+    BinaryWriter writer(data);
+    writer.Write(type);
+    writer.Write((int32_t)firstHandle);
+    writer.Write((uint32_t)boxes.size());
+
+    for (auto& box : boxes)
+    {
+        writer.Write((int32_t)box.x);
+        writer.Write((int32_t)box.y);
+    }
+}
+
+void DynamicTraceRecorder::Save(const std::string& path) const
+{
+    std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(path.c_str(), "wb"), fclose);
+    if (!file)
+        throw std::runtime_error("failed to open '" + path + "' for writing");
+
+    if (fwrite(data.data(), 1, data.size(), file.get()) != data.size())
+        throw std::runtime_error("failed to write '" + path + "'");
+}
+
+static Size ReadSize(BinaryReader& reader)
+{
+    int x = reader.Read<int32_t>();
+    int y = reader.Read<int32_t>();
+
+    if (x < 0 || y < 0)
+        throw std::runtime_error("invalid box size in dynamic trace");
+
+    return Size(x, y);
+}
+
+std::vector<DynamicOp> ReadDynamicTrace(const void* data, size_t size)
+{
+    BinaryReader reader(data, size);
+
+    if (reader.Read<uint32_t>() != DynamicTraceMagic)
+        throw std::runtime_error("invalid dynamic trace");
+
+    if (reader.Read<uint32_t>() != DynamicTraceVersion)
+        throw std::runtime_error("unsupported dynamic trace version");
+
+    std::vector<DynamicOp> ops;
+
+    while (!reader.AtEnd())
+    {
+        DynamicOp op;
+        op.type = reader.Read<DynamicOpType>();
+
+        switch (op.type)
+        {
+        case DynamicOpType::Start:
+        {
+            int binSize = reader.Read<int32_t>();
+            op.size = Size(binSize, binSize);
+            op.padding = reader.Read<int32_t>();
+            op.allowRotation = reader.Read<uint8_t>() != 0;
+            break;
+        }
+        case DynamicOpType::PackBox:
+            op.size = ReadSize(reader);
+            op.handle = reader.Read<int32_t>();
+            break;
+
+        case DynamicOpType::FreeBox:
+            op.handle = reader.Read<int32_t>();
+            break;
+
+        case DynamicOpType::Compact:
+            op.maxMoves = reader.Read<int32_t>();
+            op.timeLimit = std::chrono::microseconds(reader.Read<int64_t>());
+            break;
+
+        case DynamicOpType::PackBatch:
+        case DynamicOpType::PackSingleBin:
+        {
+            op.handle = reader.Read<int32_t>();
+            uint32_t count = reader.Read<uint32_t>();
+
+            // each box takes 8 bytes, so a bogus count runs out of data first
+            for (uint32_t i = 0; i < count; ++i)
+                op.batch.push_back(ReadSize(reader));
+
+            break;
+        }
+        default:
+            throw std::runtime_error("invalid operation in dynamic trace");
+        }
+
+        ops.push_back(std::move(op));
+    }
+
+    return ops;
+}
+
+}
@@ -0,0 +1,70 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <chrono>
+#include <Size.h>
+
+namespace binpacking
+{
+
+constexpr uint32_t DynamicTraceMagic = 0x54445042; // "BPDT"
+constexpr uint32_t DynamicTraceVersion = 2;
+
+enum class DynamicOpType : uint8_t
+{
+    Start = 1,    // StartDynamicPacking(size.x, padding, allowRotation)
+    PackBox = 2,  // PackBox(size)
+    FreeBox = 3,  // FreeBox(handle)
+    PackBatch = 4,     // PackBoxBatch(batch)
+    PackSingleBin = 5, // single-bin transaction staging 'batch'
+    Compact = 6        // Compact(maxMoves, timeLimit)
+};
+
+struct DynamicOp
+{
+    DynamicOpType type = DynamicOpType::PackBox;
+    Size size;
+    int padding = 0;
+    bool allowRotation = true;
+    int handle = -1;  // FreeBox's handle, or the first handle a pack assigned, -1 if none
+    int maxMoves = 0;
+    std::chrono::microseconds timeLimit { 0 };
+    std::vector<Size> batch;
+};
+
+// Records dynamic packing calls into a compact binary trace.
+// Attach it with BinPacker::SetRecorder.
+class DynamicTraceRecorder
+{
+    std::vector<uint8_t> data;
+
+    void WriteBoxes(DynamicOpType type, const std::vector<Size>& boxes, int firstHandle);
+
+public:
+    DynamicTraceRecorder();
+
+    void RecordStart(int binSize, int boxPadding, bool allowRotation);
+    // Packs record the first handle they assigned, or -1 if they assigned none,
+    // so that a replay can tell when its results diverge from the trace.
+    void RecordPackBox(const Size& box, int handle);
+    void RecordFreeBox(int handle);
+    void RecordPackBatch(const std::vector<Size>& boxes, int firstHandle);
+    void RecordPackSingleBin(const std::vector<Size>& boxes, int firstHandle);
+    void RecordCompact(int maxMoves, std::chrono::microseconds timeLimit);
+
+    const std::vector<uint8_t>& GetData() const {
+        return data;
+    }
+
+    void Save(const std::string& path) const;
+};
+
+std::vector<DynamicOp> ReadDynamicTrace(const void* data, size_t size);
+
+}
@@ -0,0 +1,155 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <FlatLayout.h>
+#include <stdexcept>
+#include <cstring>
+#include <cstdio>
+#include <memory>
+
+namespace binpacking
+{
+
+static uint32_t GetMappingCount(const std::vector<Bin>& bins)
+{
+    int count = 0;
+
+    for (auto& bin : bins)
+    {
+        for (auto& mapping : bin.mappings)
+            count = std::max(count, mapping.inputIndex + 1);
+    }
+
+    return (uint32_t)count;
+}
+
+size_t GetFlatLayoutSize(const std::vector<Bin>& bins)
+{
+    return sizeof(FlatHeader)
+        + sizeof(FlatBin) * bins.size()
+        + sizeof(FlatMapping) * GetMappingCount(bins);
+}
+
+void WriteFlatLayout(const std::vector<Bin>& bins, void* dest, size_t size)
+{
+    uint32_t mappingCount = GetMappingCount(bins);
+
+    FlatHeader header;
+    header.magic = FlatLayoutMagic;
+    header.version = FlatLayoutVersion;
+    header.binCount = (uint32_t)bins.size();
+    header.mappingCount = mappingCount;
+    header.binTableOffset = sizeof(FlatHeader);
+    header.mappingTableOffset = header.binTableOffset + sizeof(FlatBin) * bins.size();
+
+    if (size < header.mappingTableOffset + sizeof(FlatMapping) * mappingCount)
+        throw std::runtime_error("destination is too small for flat layout");
+
+    uint8_t* data = (uint8_t*)dest;
+    memcpy(data, &header, sizeof(header));
+
+    auto flatBins = (FlatBin*)(data + header.binTableOffset);
+    auto flatMappings = (FlatMapping*)(data + header.mappingTableOffset);
+
+    for (uint32_t i = 0; i < mappingCount; ++i)
+    {
+        flatMappings[i] = FlatMapping();
+        flatMappings[i].bin = -1;
+    }
+
+    for (size_t b = 0; b < bins.size(); ++b)
+    {
+        auto& bin = bins[b];
+
+        flatBins[b].width = bin.size.x;
+        flatBins[b].height = bin.size.y;
+        flatBins[b].mappingCount = (uint32_t)bin.mappings.size();
+        flatBins[b].reserved = 0;
+
+        for (auto& mapping : bin.mappings)
+        {
+            auto& fm = flatMappings[mapping.inputIndex];
+            fm.bin = (int32_t)b;
+            fm.x = mapping.mappedRect.x;
+            fm.y = mapping.mappedRect.y;
+            fm.w = mapping.mappedRect.w;
+            fm.h = mapping.mappedRect.h;
+            fm.inputWidth = mapping.inputSize.x;
+            fm.inputHeight = mapping.inputSize.y;
+            fm.flags = mapping.rotated ? (uint32_t)FlatMapping::Rotated : 0u;
+        }
+    }
+}
+
+void WriteFlatLayout(const std::vector<Bin>& bins, std::vector<uint8_t>& out)
+{
+    out.resize(GetFlatLayoutSize(bins));
+    WriteFlatLayout(bins, out.data(), out.size());
+}
+
+void SaveFlatLayout(const std::vector<Bin>& bins, const std::string& path)
+{
+    std::vector<uint8_t> data;
+    WriteFlatLayout(bins, data);
+
+    std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(path.c_str(), "wb"), fclose);
+    if (!file)
+        throw std::runtime_error("failed to open '" + path + "' for writing");
+
+    if (fwrite(data.data(), 1, data.size(), file.get()) != data.size())
+        throw std::runtime_error("failed to write '" + path + "'");
+}
+
+FlatLayoutView::FlatLayoutView(const void* data, size_t size)
+    : data((const uint8_t*)data), size(size)
+{
+    if (size < sizeof(FlatHeader) || ((uintptr_t)data % alignof(FlatHeader)) != 0)
+        throw std::runtime_error("invalid flat layout");
+
+    auto& header = GetHeader();
+
+    if (header.magic != FlatLayoutMagic)
+        throw std::runtime_error("invalid flat layout");
+
+    if (header.version != FlatLayoutVersion)
+        throw std::runtime_error("unsupported flat layout version");
+
+    if (header.binTableOffset % alignof(FlatBin) != 0 ||
+        header.mappingTableOffset % alignof(FlatMapping) != 0 ||
+        header.binTableOffset > size ||
+        header.mappingTableOffset > size ||
+        (size - header.binTableOffset) / sizeof(FlatBin) < header.binCount ||
+        (size - header.mappingTableOffset) / sizeof(FlatMapping) < header.mappingCount)
+    {
+        throw std::runtime_error("truncated flat layout");
+    }
+}
+
+std::vector<Bin> FlatLayoutView::ToBins() const
+{
+    std::vector<Bin> bins;
+    bins.reserve(GetBinCount());
+
+    auto flatBins = GetBins();
+    for (int i = 0; i < GetBinCount(); ++i)
+        bins.emplace_back(Size(flatBins[i].width, flatBins[i].height));
+
+    auto flatMappings = GetMappings();
+    for (int i = 0; i < GetMappingCount(); ++i)
+    {
+        auto& fm = flatMappings[i];
+        if (fm.bin < 0 || fm.bin >= GetBinCount())
+            continue;
+
+        RectMapping mapping(Size(fm.inputWidth, fm.inputHeight), i);
+        mapping.mappedRect = Rect(fm.x, fm.y, fm.w, fm.h);
+        mapping.rotated = (fm.flags & FlatMapping::Rotated) != 0;
+        bins[fm.bin].mappings.push_back(mapping);
+    }
+
+    return bins;
+}
+
+}
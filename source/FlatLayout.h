@@ -0,0 +1,101 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <string>
+#include <Bin.h>
+
+namespace binpacking
+{
+
+// Flat binary layout of a packing result, meant to be memory mapped and used in place.
+//
+//   FlatHeader
+//   FlatBin[binCount]
+//   FlatMapping[mappingCount]   indexed by RectMapping::inputIndex
+//
+// All fields are little-endian and naturally aligned.
+// Input indices that have no mapping have a 'bin' of -1.
+
+constexpr uint32_t FlatLayoutMagic = 0x4C465042; // "BPFL"
+constexpr uint32_t FlatLayoutVersion = 1;
+
+struct FlatHeader
+{
+    uint32_t magic;
+    uint32_t version;
+    uint32_t binCount;
+    uint32_t mappingCount;
+    uint64_t binTableOffset;
+    uint64_t mappingTableOffset;
+};
+
+struct FlatBin
+{
+    int32_t width;
+    int32_t height;
+    uint32_t mappingCount;
+    uint32_t reserved;
+};
+
+struct FlatMapping
+{
+    enum : uint32_t {
+        Rotated = 1
+    };
+
+    int32_t bin;
+    int32_t x, y, w, h;
+    int32_t inputWidth;
+    int32_t inputHeight;
+    uint32_t flags;
+};
+
+static_assert(sizeof(FlatHeader) == 32, "unexpected FlatHeader size");
+static_assert(sizeof(FlatBin) == 16, "unexpected FlatBin size");
+static_assert(sizeof(FlatMapping) == 32, "unexpected FlatMapping size");
+
+size_t GetFlatLayoutSize(const std::vector<Bin>& bins);
+void WriteFlatLayout(const std::vector<Bin>& bins, void* dest, size_t size);
+void WriteFlatLayout(const std::vector<Bin>& bins, std::vector<uint8_t>& out);
+void SaveFlatLayout(const std::vector<Bin>& bins, const std::string& path);
+
+// Read-only view of a flat layout. The data isn't copied, and must outlive the view.
+class FlatLayoutView
+{
+    const uint8_t* data = nullptr;
+    size_t size = 0;
+
+public:
+    FlatLayoutView(){}
+    FlatLayoutView(const void* data, size_t size);
+
+    const FlatHeader& GetHeader() const {
+        return *(const FlatHeader*)data;
+    }
+
+    int GetBinCount() const {
+        return (int)GetHeader().binCount;
+    }
+
+    int GetMappingCount() const {
+        return (int)GetHeader().mappingCount;
+    }
+
+    const FlatBin* GetBins() const {
+        return (const FlatBin*)(data + GetHeader().binTableOffset);
+    }
+
+    const FlatMapping* GetMappings() const {
+        return (const FlatMapping*)(data + GetHeader().mappingTableOffset);
+    }
+
+    std::vector<Bin> ToBins() const;
+};
+
+}
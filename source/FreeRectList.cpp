@@ -0,0 +1,134 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <FreeRectList.h>
+#include <algorithm>
+#include <climits>
+
+namespace binpacking
+{
+
+static bool Intersects(const Rect& a, const Rect& b)
+{
+    return a.x < b.x + b.w && b.x < a.x + a.w
+        && a.y < b.y + b.h && b.y < a.y + a.h;
+}
+
+static bool Contains(const Rect& outer, const Rect& inner)
+{
+    return inner.x >= outer.x && inner.y >= outer.y
+        && inner.x + inner.w <= outer.x + outer.w
+        && inner.y + inner.h <= outer.y + outer.h;
+}
+
+FreeRectList::FreeRectList(const Size& binSize)
+    : binSize(binSize)
+{
+    freeRects.push_back(Rect(binSize));
+}
+
+void FreeRectList::Reserve(const Rect& rc)
+{
+    // clip to the bin so that padded rectangles can be passed in
+    int x0 = std::max(rc.x, 0);
+    int y0 = std::max(rc.y, 0);
+    int x1 = std::min(rc.x + rc.w, binSize.x);
+    int y1 = std::min(rc.y + rc.h, binSize.y);
+
+    if (x1 <= x0 || y1 <= y0)
+        return;
+
+    Rect used(x0, y0, x1 - x0, y1 - y0);
+    newRects.clear();
+
+    for (size_t i = 0; i < freeRects.size(); )
+    {
+        if (Intersects(freeRects[i], used))
+        {
+            Split(freeRects[i], used);
+            freeRects[i] = freeRects.back();
+            freeRects.pop_back();
+        }
+        else
+        {
+            ++i;
+        }
+    }
+
+    PruneNewRects();
+}
+
+void FreeRectList::Split(const Rect& fr, const Rect& used)
+{
+    if (used.x > fr.x)
+        newRects.push_back(Rect(fr.x, fr.y, used.x - fr.x, fr.h));
+
+    if (used.x + used.w < fr.x + fr.w)
+        newRects.push_back(Rect(used.x + used.w, fr.y, fr.x + fr.w - (used.x + used.w), fr.h));
+
+    if (used.y > fr.y)
+        newRects.push_back(Rect(fr.x, fr.y, fr.w, used.y - fr.y));
+
+    if (used.y + used.h < fr.y + fr.h)
+        newRects.push_back(Rect(fr.x, used.y + used.h, fr.w, fr.y + fr.h - (used.y + used.h)));
+}
+
+void FreeRectList::PruneNewRects()
+{
+    // The remaining rects were maximal before the split and none of them can be inside
+    // a piece of a rect that was split, so only the new rects need to be checked.
+    size_t oldCount = freeRects.size();
+
+    for (size_t i = 0; i < newRects.size(); ++i)
+    {
+        bool redundant = false;
+
+        for (size_t j = 0; j < oldCount && !redundant; ++j)
+            redundant = Contains(freeRects[j], newRects[i]);
+
+        // of two identical rects, the first one is kept
+        for (size_t j = 0; j < newRects.size() && !redundant; ++j)
+        {
+            redundant = j != i && Contains(newRects[j], newRects[i])
+                && (j < i || !Contains(newRects[i], newRects[j]));
+        }
+
+        if (!redundant)
+            freeRects.push_back(newRects[i]);
+    }
+}
+
+bool FreeRectList::FindPosition(const Size& box, bool allowRotation, Rect& rc, bool& rotated) const
+{
+    int bestShort = INT_MAX;
+    int bestLong = INT_MAX;
+
+    for (auto& fr : freeRects)
+    {
+        for (int r = 0; r < (allowRotation ? 2 : 1); ++r)
+        {
+            int w = r ? box.y : box.x;
+            int h = r ? box.x : box.y;
+
+            if (w > fr.w || h > fr.h)
+                continue;
+
+            int leftoverShort = std::min(fr.w - w, fr.h - h);
+            int leftoverLong = std::max(fr.w - w, fr.h - h);
+
+            if (leftoverShort < bestShort || (leftoverShort == bestShort && leftoverLong < bestLong))
+            {
+                bestShort = leftoverShort;
+                bestLong = leftoverLong;
+                rc = Rect(fr.x, fr.y, w, h);
+                rotated = (r == 1);
+            }
+        }
+    }
+
+    return bestShort != INT_MAX;
+}
+
+}
@@ -0,0 +1,41 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <Size.h>
+#include <Rect.h>
+
+namespace binpacking
+{
+
+// Free space of a bin as a list of maximal, possibly overlapping, free rectangles.
+// Unlike the node tree, space can be reserved anywhere, which makes it
+// suitable for packing around rectangles that must stay where they are.
+class FreeRectList
+{
+    std::vector<Rect> freeRects;
+    std::vector<Rect> newRects;
+    Size binSize;
+
+    void Split(const Rect& freeRect, const Rect& used);
+    void PruneNewRects();
+
+public:
+    FreeRectList(const Size& binSize);
+
+    // Marks 'rc' as used.
+    void Reserve(const Rect& rc);
+
+    // Finds the free rectangle that leaves the shortest leftover side after placing a box.
+    // Returns false if the box doesn't fit anywhere.
+    bool FindPosition(const Size& box, bool allowRotation, Rect& rc, bool& rotated) const;
+
+    const std::vector<Rect>& GetFreeRects() const {
+        return freeRects;
+    }
+};
+
+}
@@ -0,0 +1,62 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace binpacking
+{
+
+// Fast non-cryptographic 64-bit hash, fed 8 bytes at a time.
+class Hasher
+{
+    constexpr static uint64_t Prime1 = 0x9E3779B185EBCA87ULL;
+    constexpr static uint64_t Prime2 = 0xC2B2AE3D27D4EB4FULL;
+
+    uint64_t h = Prime1;
+
+public:
+    void Add(uint64_t v)
+    {
+        v *= Prime2;
+        v = (v << 31) | (v >> 33);
+        v *= Prime1;
+        h ^= v;
+        h = ((h << 27) | (h >> 37)) * Prime1 + Prime2;
+    }
+
+    void AddBytes(const void* data, size_t size)
+    {
+        const uint8_t* p = (const uint8_t*)data;
+        size_t i = 0;
+
+        for ( ; i + 8 <= size; i += 8)
+        {
+            uint64_t v;
+            memcpy(&v, p + i, 8);
+            Add(v);
+        }
+
+        if (i < size)
+        {
+            uint64_t v = 0;
+            memcpy(&v, p + i, size - i);
+            Add(v ^ ((uint64_t)(size - i) << 56));
+        }
+    }
+
+    uint64_t Finish() const
+    {
+        uint64_t ret = h;
+        ret ^= ret >> 33;
+        ret *= Prime2;
+        ret ^= ret >> 29;
+        return ret;
+    }
+};
+
+}
@@ -0,0 +1,77 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <vector>
+#include <Size.h>
+#include <Rect.h>
+
+namespace binpacking
+{
+
+// Non-owning view of 8-bit pixels with 1 (single channel) or 4 (RGBA) channels per pixel.
+struct ImageView
+{
+    const uint8_t* data = nullptr;
+    int width = 0;
+    int height = 0;
+    int stride = 0;    // bytes per row
+    int channels = 4;
+
+    ImageView(){}
+    ImageView(const uint8_t* data, int width, int height, int channels, int stride = 0)
+        : data(data), width(width), height(height),
+        stride(stride ? stride : width * channels), channels(channels) {}
+
+    const uint8_t* GetRow(int y) const {
+        return data + (size_t)y * stride;
+    }
+
+    Size size() const {
+        return Size(width, height);
+    }
+
+    ImageView SubView(const Rect& rc) const {
+        return ImageView(GetRow(rc.y) + rc.x * channels, rc.w, rc.h, channels, stride);
+    }
+};
+
+// Tightly packed image that owns its pixels.
+class Image
+{
+    std::vector<uint8_t> pixels;
+    int width = 0;
+    int height = 0;
+    int channels = 4;
+
+public:
+    Image(){}
+    Image(int width, int height, int channels)
+        : pixels((size_t)width * height * channels), width(width), height(height), channels(channels) {}
+
+    int GetWidth() const { return width; }
+    int GetHeight() const { return height; }
+    int GetChannels() const { return channels; }
+    int GetStride() const { return width * channels; }
+
+    uint8_t* GetData() { return pixels.data(); }
+    const uint8_t* GetData() const { return pixels.data(); }
+
+    uint8_t* GetRow(int y) {
+        return pixels.data() + (size_t)y * GetStride();
+    }
+
+    const uint8_t* GetRow(int y) const {
+        return pixels.data() + (size_t)y * GetStride();
+    }
+
+    ImageView GetView() const {
+        return ImageView(pixels.data(), width, height, channels);
+    }
+};
+
+}
@@ -0,0 +1,186 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <LayoutCache.h>
+#include <Hash.h>
+#include <atomic>
+#include <cstdio>
+#include <memory>
+#include <stdexcept>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/stat.h>
+#include <unistd.h>
+#include <cerrno>
+#endif
+
+namespace binpacking
+{
+
+#ifdef _WIN32
+
+static void CreateDirectoryIfMissing(const std::string& path)
+{
+    if (!CreateDirectoryA(path.c_str(), nullptr) && GetLastError() != ERROR_ALREADY_EXISTS)
+        throw std::runtime_error("failed to create directory '" + path + "'");
+}
+
+static bool ReplaceFile(const std::string& from, const std::string& to)
+{
+    return MoveFileExA(from.c_str(), to.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+}
+
+static unsigned long GetProcessId()
+{
+    return GetCurrentProcessId();
+}
+
+#else
+
+static void CreateDirectoryIfMissing(const std::string& path)
+{
+    if (mkdir(path.c_str(), 0777) != 0 && errno != EEXIST)
+        throw std::runtime_error("failed to create directory '" + path + "'");
+}
+
+static bool ReplaceFile(const std::string& from, const std::string& to)
+{
+    return rename(from.c_str(), to.c_str()) == 0;
+}
+
+static unsigned long GetProcessId()
+{
+    return (unsigned long)getpid();
+}
+
+#endif
+
+LayoutCache::LayoutCache(const std::string& directory)
+    : directory(directory)
+{
+    CreateDirectoryIfMissing(directory);
+}
+
+uint64_t LayoutCache::Fingerprint(
+    const std::vector<Size>& sizes, int maxSize, int padding, bool allowRotation,
+    const BinPacker::Options& options)
+{
+    Hasher hasher;
+    hasher.Add(PackerVersion);
+    hasher.Add(FlatLayoutVersion);
+    hasher.Add((uint64_t)(uint32_t)maxSize << 32 | (uint32_t)padding);
+    hasher.Add(allowRotation);
+    hasher.Add(options.adaptiveOrdering);
+    hasher.Add((uint64_t)(uint32_t)options.adaptiveWindow << 32 | (uint32_t)options.adaptiveExploreInterval);
+    hasher.Add(sizes.size());
+
+    for (auto& size : sizes)
+        hasher.Add((uint64_t)(uint32_t)size.x << 32 | (uint32_t)size.y);
+
+    return hasher.Finish();
+}
+
+std::string LayoutCache::GetPath(uint64_t fingerprint) const
+{
+    char name[32];
+    snprintf(name, sizeof(name), "%016llx.bpfl", (unsigned long long)fingerprint);
+    return directory + "/" + name;
+}
+
+bool LayoutCache::Load(
+    const std::vector<Size>& sizes, int maxSize, int padding, bool allowRotation,
+    CachedLayout& layout, const BinPacker::Options& options) const
+{
+    std::string path = GetPath(Fingerprint(sizes, maxSize, padding, allowRotation, options));
+
+    try
+    {
+        CachedLayout cached(MappedFile{ path });
+        auto& view = cached.GetView();
+
+        // guard against fingerprint collisions by checking every input size
+        if (view.GetMappingCount() != (int)sizes.size())
+            return false;
+
+        auto mappings = view.GetMappings();
+        for (size_t i = 0; i < sizes.size(); ++i)
+        {
+            if (mappings[i].bin < 0 ||
+                mappings[i].inputWidth != sizes[i].x ||
+                mappings[i].inputHeight != sizes[i].y)
+            {
+                return false;
+            }
+        }
+
+        layout = std::move(cached);
+        return true;
+    }
+    catch (std::runtime_error&)
+    {
+        // missing or corrupt files are misses
+        return false;
+    }
+}
+
+void LayoutCache::Store(
+    const std::vector<Size>& sizes, int maxSize, int padding, bool allowRotation,
+    const std::vector<Bin>& bins, const BinPacker::Options& options) const
+{
+    static std::atomic<unsigned int> counter { 0 };
+
+    std::string path = GetPath(Fingerprint(sizes, maxSize, padding, allowRotation, options));
+
+    char suffix[64];
+    snprintf(suffix, sizeof(suffix), ".%lu-%u.tmp", GetProcessId(), counter++);
+    std::string tempPath = path + suffix;
+
+    std::vector<uint8_t> data;
+    WriteFlatLayout(bins, data);
+
+    {
+        std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(tempPath.c_str(), "wb"), fclose);
+        if (!file)
+            throw std::runtime_error("failed to open '" + tempPath + "' for writing");
+
+        bool written = fwrite(data.data(), 1, data.size(), file.get()) == data.size();
+        written = (fclose(file.release()) == 0) && written;
+
+        if (!written) {
+            remove(tempPath.c_str());
+            throw std::runtime_error("failed to write '" + tempPath + "'");
+        }
+    }
+
+    if (!ReplaceFile(tempPath, path)) {
+        remove(tempPath.c_str());
+        throw std::runtime_error("failed to move '" + tempPath + "' into place");
+    }
+}
+
+CachedLayout LayoutCache::Pack(
+    BinPacker& packer, const std::vector<Size>& sizes,
+    int maxSize, int padding, bool allowRotation) const
+{
+    CachedLayout layout;
+    auto options = packer.GetOptions();
+
+    if (!Load(sizes, maxSize, padding, allowRotation, layout, options))
+    {
+        packer.PackBoxes(sizes, maxSize, padding, allowRotation);
+        Store(sizes, maxSize, padding, allowRotation, packer.GetBins(), options);
+
+        if (!Load(sizes, maxSize, padding, allowRotation, layout, options))
+            throw std::runtime_error("failed to read back cached layout");
+    }
+
+    return layout;
+}
+
+}
@@ -0,0 +1,73 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <Size.h>
+#include <Bin.h>
+#include <BinPacking.h>
+#include <FlatLayout.h>
+#include <MappedFile.h>
+
+namespace binpacking
+{
+
+// Packing result read from the cache, mapped into memory.
+class CachedLayout
+{
+    MappedFile file;
+    FlatLayoutView view;
+
+public:
+    CachedLayout(){}
+    CachedLayout(MappedFile&& file)
+        : file(std::move(file)), view(this->file.GetData(), this->file.GetSize()) {}
+
+    const FlatLayoutView& GetView() const {
+        return view;
+    }
+};
+
+// Directory of flat layouts keyed by a fingerprint of the packing inputs.
+// Files are written to a temporary name and renamed into place, so concurrent
+// builds sharing a directory never see a partially written layout.
+class LayoutCache
+{
+    std::string directory;
+
+    std::string GetPath(uint64_t fingerprint) const;
+
+public:
+    // Part of every fingerprint. Must be changed whenever the packer's results change.
+    constexpr static uint32_t PackerVersion = 3;
+
+    LayoutCache(const std::string& directory);
+
+    // Covers the arguments and options of PackBoxes. With adaptive ordering, results also depend
+    // on what the packer packed before, so a cached layout is one the options can produce,
+    // not necessarily the one the packer would produce next.
+    static uint64_t Fingerprint(
+        const std::vector<Size>& sizes, int maxSize, int padding, bool allowRotation,
+        const BinPacker::Options& options = BinPacker::Options());
+
+    // Returns true if a layout for these inputs was found.
+    bool Load(
+        const std::vector<Size>& sizes, int maxSize, int padding, bool allowRotation,
+        CachedLayout& layout, const BinPacker::Options& options = BinPacker::Options()) const;
+
+    void Store(
+        const std::vector<Size>& sizes, int maxSize, int padding, bool allowRotation,
+        const std::vector<Bin>& bins, const BinPacker::Options& options = BinPacker::Options()) const;
+
+    // Returns the cached layout for these inputs and the packer's options,
+    // packing and storing it first if there isn't one.
+    CachedLayout Pack(
+        BinPacker& packer, const std::vector<Size>& sizes,
+        int maxSize, int padding, bool allowRotation) const;
+};
+
+}
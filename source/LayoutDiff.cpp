@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <LayoutDiff.h>
+#include <DirtyRegion.h>
+#include <algorithm>
+
+namespace binpacking
+{
+
+struct Placement
+{
+    int bin = -1;
+    const RectMapping* mapping = nullptr;
+};
+
+static void IndexLayout(const std::vector<Bin>& bins, std::vector<Placement>& placements)
+{
+    for (size_t b = 0; b < bins.size(); ++b)
+    {
+        for (auto& mapping : bins[b].mappings)
+        {
+            if (mapping.inputIndex < 0)
+                continue;
+
+            if (mapping.inputIndex >= (int)placements.size())
+                placements.resize(mapping.inputIndex + 1);
+
+            placements[mapping.inputIndex] = { (int)b, &mapping };
+        }
+    }
+}
+
+static bool SameRect(const Rect& a, const Rect& b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+LayoutDiff DiffLayouts(const std::vector<Bin>& oldBins, const std::vector<Bin>& newBins)
+{
+    std::vector<Placement> oldPlacements;
+    std::vector<Placement> newPlacements;
+    IndexLayout(oldBins, oldPlacements);
+    IndexLayout(newBins, newPlacements);
+
+    size_t binCount = std::max(oldBins.size(), newBins.size());
+    std::vector<DirtyRegion> regions(binCount);
+    std::vector<bool> wholeBin(binCount, false);
+
+    for (size_t b = 0; b < binCount; ++b)
+    {
+        if (b >= oldBins.size() || b >= newBins.size()
+            || oldBins[b].size.x != newBins[b].size.x
+            || oldBins[b].size.y != newBins[b].size.y)
+        {
+            wholeBin[b] = true;
+        }
+    }
+
+    LayoutDiff diff;
+    size_t count = std::max(oldPlacements.size(), newPlacements.size());
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        Placement before = i < oldPlacements.size() ? oldPlacements[i] : Placement();
+        Placement after = i < newPlacements.size() ? newPlacements[i] : Placement();
+
+        if (!before.mapping && !after.mapping)
+            continue;
+
+        if (!before.mapping)
+        {
+            diff.added.push_back((int)i);
+        }
+        else if (!after.mapping)
+        {
+            diff.removed.push_back((int)i);
+        }
+        else if (before.bin != after.bin
+            || !SameRect(before.mapping->mappedRect, after.mapping->mappedRect)
+            || before.mapping->rotated != after.mapping->rotated)
+        {
+            diff.moved.push_back((int)i);
+        }
+        else
+        {
+            continue;
+        }
+
+        if (before.mapping && !wholeBin[before.bin])
+            regions[before.bin].Add(before.mapping->mappedRect);
+
+        if (after.mapping && !wholeBin[after.bin])
+            regions[after.bin].Add(after.mapping->mappedRect);
+    }
+
+    diff.changedRegions.resize(binCount);
+
+    for (size_t b = 0; b < binCount; ++b)
+    {
+        if (wholeBin[b])
+        {
+            Size size = b < newBins.size() ? newBins[b].size : oldBins[b].size;
+
+            if (b < oldBins.size() && b < newBins.size())
+            {
+                size.x = std::max(oldBins[b].size.x, newBins[b].size.x);
+                size.y = std::max(oldBins[b].size.y, newBins[b].size.y);
+            }
+
+            diff.changedRegions[b].push_back(Rect(size));
+        }
+        else
+        {
+            diff.changedRegions[b] = regions[b].Take();
+        }
+    }
+
+    return diff;
+}
+
+}
@@ -0,0 +1,32 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <Rect.h>
+#include <Bin.h>
+
+namespace binpacking
+{
+
+struct LayoutDiff
+{
+    std::vector<int> moved;    // in both layouts, but with a different bin, rectangle or rotation
+    std::vector<int> added;    // only in the new layout
+    std::vector<int> removed;  // only in the old layout
+
+    // Areas that changed, indexed by bin. Covers the old and new rectangles of moved,
+    // added and removed inputs, or the whole bin if the bin was resized, added or removed.
+    std::vector<std::vector<Rect>> changedRegions;
+
+    bool IsEmpty() const {
+        return moved.empty() && added.empty() && removed.empty();
+    }
+};
+
+// Compares two layouts keyed by RectMapping::inputIndex.
+LayoutDiff DiffLayouts(const std::vector<Bin>& oldBins, const std::vector<Bin>& newBins);
+
+}
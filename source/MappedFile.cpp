@@ -0,0 +1,156 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <MappedFile.h>
+#include <stdexcept>
+#include <utility>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+namespace binpacking
+{
+
+#ifdef _WIN32
+
+MappedFile::MappedFile(const std::string& path)
+{
+    HANDLE hFile = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr,
+        OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+
+    if (hFile == INVALID_HANDLE_VALUE)
+        throw std::runtime_error("failed to open '" + path + "'");
+
+    file = hFile;
+
+    LARGE_INTEGER fileSize;
+    if (!GetFileSizeEx(hFile, &fileSize)) {
+        Close();
+        throw std::runtime_error("failed to get size of '" + path + "'");
+    }
+
+    size = (size_t)fileSize.QuadPart;
+    if (size == 0)
+        return;
+
+    mapping = CreateFileMappingA(hFile, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (mapping)
+        data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+
+    if (!data) {
+        Close();
+        throw std::runtime_error("failed to map '" + path + "'");
+    }
+}
+
+void MappedFile::Close()
+{
+    if (data) UnmapViewOfFile(data);
+    if (mapping) CloseHandle(mapping);
+    if (file) CloseHandle(file);
+
+    data = nullptr;
+    size = 0;
+    mapping = nullptr;
+    file = nullptr;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(other.data), size(other.size), file(other.file), mapping(other.mapping)
+{
+    other.data = nullptr;
+    other.size = 0;
+    other.file = nullptr;
+    other.mapping = nullptr;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(file, other.file);
+        std::swap(mapping, other.mapping);
+    }
+
+    return *this;
+}
+
+#else
+
+MappedFile::MappedFile(const std::string& path)
+{
+    fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("failed to open '" + path + "'");
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        Close();
+        throw std::runtime_error("failed to get size of '" + path + "'");
+    }
+
+    size = (size_t)st.st_size;
+    if (size == 0)
+        return;
+
+    void* ptr = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    if (ptr == MAP_FAILED) {
+        Close();
+        throw std::runtime_error("failed to map '" + path + "'");
+    }
+
+    data = ptr;
+}
+
+void MappedFile::Close()
+{
+    if (data) munmap((void*)data, size);
+    if (fd >= 0) close(fd);
+
+    data = nullptr;
+    size = 0;
+    fd = -1;
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data(other.data), size(other.size), fd(other.fd)
+{
+    other.data = nullptr;
+    other.size = 0;
+    other.fd = -1;
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept
+{
+    if (this != &other)
+    {
+        Close();
+        std::swap(data, other.data);
+        std::swap(size, other.size);
+        std::swap(fd, other.fd);
+    }
+
+    return *this;
+}
+
+#endif
+
+MappedFile::~MappedFile()
+{
+    Close();
+}
+
+}
@@ -0,0 +1,47 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstddef>
+#include <string>
+
+namespace binpacking
+{
+
+// Read-only memory mapping of a whole file.
+class MappedFile
+{
+    const void* data = nullptr;
+    size_t size = 0;
+#ifdef _WIN32
+    void* file = nullptr;
+    void* mapping = nullptr;
+#else
+    int fd = -1;
+#endif
+
+    void Close();
+
+public:
+    MappedFile(){}
+    MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const void* GetData() const {
+        return data;
+    }
+
+    size_t GetSize() const {
+        return size;
+    }
+};
+
+}
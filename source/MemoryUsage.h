@@ -0,0 +1,27 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstddef>
+
+namespace binpacking
+{
+
+// Bytes held by a packer, by category. Heap bookkeeping overhead isn't included.
+struct MemoryUsage
+{
+    size_t treeNodes = 0;     // nodes attached to bin trees, including spare subtrees kept for reuse
+    size_t nodePool = 0;      // free nodes pooled by the node allocator
+    size_t mappings = 0;      // mapping list nodes of every bin
+    size_t bins = 0;          // bin storage and dirty regions
+    size_t dynamicBoxes = 0;  // handle table of dynamic packing
+    size_t scratch = 0;       // sorted input copies and other buffers reused between calls
+
+    size_t Total() const {
+        return treeNodes + nodePool + mappings + bins + dynamicBoxes + scratch;
+    }
+};
+
+}
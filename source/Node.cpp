@@ -1,5 +1,6 @@
 #include <Node.h>
 #include <NodeAllocator.h>
+#include <PackStats.h>
 #include <cassert>
 
 namespace binpacking
@@ -16,6 +17,8 @@ void Node::Reset(const Rect& rc)
 
 Node* Node::Insert(RectMapping& mapping, int padding, bool allowRotation)
 {
+    BINPACKING_STAT(nodeVisits);
+
     if(type == NodeType::Empty)
     {
         if(mapping.inputSize.x == rect.w &&
@@ -112,4 +115,48 @@ void Node::SplitBranch(int padding)
     }
 }
 
+bool Node::Remove(const RectMapping* mapping)
+{
+    if(type == NodeType::Empty)
+        return false;
+
+    if(pMapping == mapping)
+    {
+        // a branch keeps its children, but the space that
+        // held its contents can't be reused until they're empty
+        pMapping = nullptr;
+        
+        if(type == NodeType::Leaf)
+            type = NodeType::Empty;
+    }
+    else if(type == NodeType::Branch)
+    {
+        int x = mapping->mappedRect.x;
+        int y = mapping->mappedRect.y;
+
+        Node* child = left->Contains(x, y) ? left.get() : right.get();
+        if(!child->Remove(mapping))
+            return false;
+    }
+    else
+    {
+        return false;
+    }
+
+    if(type == NodeType::Branch && !pMapping &&
+       left->type == NodeType::Empty &&
+       right->type == NodeType::Empty)
+    {
+        type = NodeType::Empty;
+    }
+
+    return true;
+}
+
+bool Node::Contains(int x, int y) const
+{
+    return x >= rect.x && x < rect.x + rect.w
+        && y >= rect.y && y < rect.y + rect.h;
+}
+
 }
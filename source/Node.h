@@ -29,6 +29,8 @@ public:
     void Reset(const Rect& rc);
     Node* Insert(RectMapping& mapping, int padding, bool allowRotation);
     void SplitBranch(int padding);
+    bool Remove(const RectMapping* mapping);
+    bool Contains(int x, int y) const;
 };
 
 }
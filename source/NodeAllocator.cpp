@@ -1,12 +1,16 @@
 #include <NodeAllocator.h>
 #include <Node.h>
+#include <PackStats.h>
 
 namespace binpacking
 {
 
 void NodeDeleter::operator()(Node* n)
 {
+    // destroying the node returns its children first
     auto alloc = n->allocator.lock();
+    n->~Node();
+
     if (alloc) {
         alloc->ReturnNode(n);
     }
@@ -36,14 +40,30 @@ NodePtr NodeAllocator::GetNode()
     if (!nodes.empty()) {
         node = nodes.back();
         nodes.pop_back();
+        BINPACKING_STAT(nodesReused);
     }
     else {
         node = (Node*)::operator new(sizeof(Node));
+        BINPACKING_STAT(nodesAllocated);
     }
 
     return NodePtr(new (node) Node(shared_from_this()));
 }
 
+size_t NodeAllocator::GetPoolBytes() const
+{
+    return nodes.size() * sizeof(Node) + nodes.capacity() * sizeof(Node*);
+}
+
+void NodeAllocator::ShrinkToFit()
+{
+    for (auto& node : nodes)
+        DeleteNode(node);
+
+    nodes.clear();
+    nodes.shrink_to_fit();
+}
+
 void NodeAllocator::ReturnNode(Node* node) {
     nodes.push_back(node);
 }
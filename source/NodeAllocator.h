@@ -26,6 +26,16 @@ public:
     ~NodeAllocator();
 
     NodePtr GetNode();
+
+    size_t GetPooledCount() const {
+        return nodes.size();
+    }
+
+    // bytes held by pooled nodes and the pool itself
+    size_t GetPoolBytes() const;
+
+    // frees every pooled node
+    void ShrinkToFit();
 };
 
 };
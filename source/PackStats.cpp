@@ -0,0 +1,15 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <PackStats.h>
+
+namespace binpacking
+{
+
+#if BINPACKING_STATS
+thread_local PackStats* detail::currentStats = nullptr;
+#endif
+
+}
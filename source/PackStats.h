@@ -0,0 +1,85 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+
+// Define BINPACKING_STATS=1 to collect hot-path counters.
+// When it's 0, the counters compile to nothing and all stats read as zero.
+#ifndef BINPACKING_STATS
+#define BINPACKING_STATS 0
+#endif
+
+namespace binpacking
+{
+
+struct PackStats
+{
+    uint64_t binTrials = 0;      // bin size and sort order combinations tried by PackBin
+    uint64_t nodeVisits = 0;     // calls to Node::Insert, including recursive ones
+    uint64_t failedInserts = 0;  // boxes that didn't fit in the bin they were tried in
+    uint64_t nodesReused = 0;    // nodes NodeAllocator handed out from its pool
+    uint64_t nodesAllocated = 0; // nodes NodeAllocator had to allocate from the heap
+
+    PackStats& operator+=(const PackStats& other)
+    {
+        binTrials += other.binTrials;
+        nodeVisits += other.nodeVisits;
+        failedInserts += other.failedInserts;
+        nodesReused += other.nodesReused;
+        nodesAllocated += other.nodesAllocated;
+        return *this;
+    }
+};
+
+#if BINPACKING_STATS
+
+namespace detail {
+    // stats of the innermost StatsScope on this thread, or null
+    extern thread_local PackStats* currentStats;
+}
+
+#define BINPACKING_STAT(counter) \
+    do { if (::binpacking::detail::currentStats) ++::binpacking::detail::currentStats->counter; } while(0)
+
+// Collects the counters of everything that runs on this thread during its lifetime,
+// and adds them to 'target' and to the enclosing scope when it ends.
+class StatsScope
+{
+    PackStats local;
+    PackStats& target;
+    PackStats* previous;
+
+public:
+    StatsScope(PackStats& target)
+        : target(target), previous(detail::currentStats)
+    {
+        detail::currentStats = &local;
+    }
+
+    ~StatsScope()
+    {
+        target += local;
+        if (previous) *previous += local;
+        detail::currentStats = previous;
+    }
+
+    StatsScope(const StatsScope&) = delete;
+    StatsScope& operator=(const StatsScope&) = delete;
+};
+
+#else
+
+#define BINPACKING_STAT(counter) ((void)0)
+
+class StatsScope
+{
+public:
+    StatsScope(PackStats&) {}
+};
+
+#endif
+
+}
@@ -0,0 +1,124 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <PackingMetrics.h>
+#include <Node.h>
+#include <algorithm>
+#include <climits>
+
+namespace binpacking
+{
+
+static int64_t Area(const Rect& rc)
+{
+    // splits can leave nodes with negative sizes when padding doesn't fit
+    return (int64_t)std::max(rc.w, 0) * std::max(rc.h, 0);
+}
+
+static void Finish(BinMetrics& m)
+{
+    m.occupancy = m.binArea > 0 ? (double)m.usedArea / m.binArea : 0.0;
+
+    // stays zero without a node tree, since the free space can't be broken down
+    int64_t largestFreeArea = Area(m.largestFreeRect);
+    m.fragmentation = largestFreeArea > 0 ? 1.0 - (double)largestFreeArea / m.freeArea : 0.0;
+}
+
+static BinMetrics ComputeBinMetrics(const Bin& bin, int smallestSide)
+{
+    BinMetrics m;
+    m.binArea = (int64_t)bin.size.x * bin.size.y;
+
+    for (auto& mapping : bin.mappings)
+        m.usedArea += mapping.mappedRect.area();
+
+    if (!bin.root)
+    {
+        m.freeArea = m.binArea - m.usedArea;
+        Finish(m);
+        return m;
+    }
+
+    std::vector<const Node*> stack;
+    stack.push_back(bin.root.get());
+
+    while (!stack.empty())
+    {
+        const Node* node = stack.back();
+        stack.pop_back();
+
+        if (node->type == NodeType::Empty)
+        {
+            int64_t area = Area(node->rect);
+
+            if (node->rect.w >= smallestSide && node->rect.h >= smallestSide)
+            {
+                m.freeArea += area;
+
+                if (area > Area(m.largestFreeRect))
+                    m.largestFreeRect = node->rect;
+            }
+            else
+            {
+                m.unusableArea += area;
+            }
+        }
+        else if (node->type == NodeType::Branch)
+        {
+            // whatever the children don't cover is the node's contents plus padding
+            int64_t remainder = Area(node->rect) - Area(node->left->rect) - Area(node->right->rect);
+
+            if (node->pMapping)
+                m.paddingArea += remainder - node->pMapping->mappedRect.area();
+            else
+                m.unusableArea += remainder;
+
+            stack.push_back(node->right.get());
+            stack.push_back(node->left.get());
+        }
+    }
+
+    Finish(m);
+    return m;
+}
+
+PackingMetrics ComputeMetrics(const std::vector<Bin>& bins)
+{
+    int smallestSide = INT_MAX;
+
+    for (auto& bin : bins)
+    {
+        for (auto& mapping : bin.mappings)
+            smallestSide = std::min(smallestSide, std::min(mapping.inputSize.x, mapping.inputSize.y));
+    }
+
+    // with nothing packed, any space counts as free
+    if (smallestSide == INT_MAX)
+        smallestSide = 1;
+
+    PackingMetrics metrics;
+    metrics.bins.reserve(bins.size());
+
+    for (auto& bin : bins)
+    {
+        BinMetrics m = ComputeBinMetrics(bin, smallestSide);
+        metrics.bins.push_back(m);
+
+        auto& t = metrics.total;
+        t.binArea += m.binArea;
+        t.usedArea += m.usedArea;
+        t.paddingArea += m.paddingArea;
+        t.freeArea += m.freeArea;
+        t.unusableArea += m.unusableArea;
+
+        if (Area(m.largestFreeRect) > Area(t.largestFreeRect))
+            t.largestFreeRect = m.largestFreeRect;
+    }
+
+    Finish(metrics.total);
+    return metrics;
+}
+
+}
@@ -0,0 +1,38 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <Rect.h>
+#include <Bin.h>
+
+namespace binpacking
+{
+
+// Areas always add up: binArea == usedArea + paddingArea + freeArea + unusableArea.
+struct BinMetrics
+{
+    int64_t binArea = 0;
+    int64_t usedArea = 0;      // covered by boxes
+    int64_t paddingArea = 0;   // lost to padding between boxes
+    int64_t freeArea = 0;      // empty space that could still fit the smallest packed box
+    int64_t unusableArea = 0;  // empty space too narrow for any packed box, or vacated by freed boxes
+    Rect largestFreeRect;      // largest empty node of the tree
+    double occupancy = 0;      // usedArea / binArea
+    double fragmentation = 0;  // 1 - largestFreeRect area / freeArea, 0 when free space is in one piece or unknown
+};
+
+struct PackingMetrics
+{
+    std::vector<BinMetrics> bins;
+    BinMetrics total;
+};
+
+// Computes metrics in one pass over the node tree of each bin.
+// Bins without a node tree only report used and free area.
+PackingMetrics ComputeMetrics(const std::vector<Bin>& bins);
+
+}
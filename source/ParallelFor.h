@@ -0,0 +1,71 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <exception>
+#include <mutex>
+#include <algorithm>
+#include <Trace.h>
+
+namespace binpacking
+{
+
+// Calls 'fn(i)' for every i in [0, count) on up to 'threadCount' threads, including the caller.
+// A 'threadCount' of 0 uses one thread per core. The first exception thrown is rethrown.
+template<class Fn>
+void ParallelFor(int count, int threadCount, const Fn& fn)
+{
+    if (threadCount <= 0)
+        threadCount = std::max(1, (int)std::thread::hardware_concurrency());
+
+    threadCount = std::min(threadCount, count);
+
+    if (threadCount <= 1)
+    {
+        for (int i = 0; i < count; ++i)
+            fn(i);
+
+        return;
+    }
+
+    std::atomic<int> next { 0 };
+    std::exception_ptr error;
+    std::mutex errorMutex;
+
+    auto worker = [&]() {
+        TraceScope trace("ParallelForWorker");
+
+        try
+        {
+            for (int i = next++; i < count; i = next++)
+                fn(i);
+        }
+        catch (...)
+        {
+            std::lock_guard<std::mutex> lock(errorMutex);
+            if (!error) error = std::current_exception();
+            next = count;
+        }
+    };
+
+    std::vector<std::thread> threads;
+    threads.reserve(threadCount - 1);
+
+    for (int t = 1; t < threadCount; ++t)
+        threads.emplace_back(worker);
+
+    worker();
+
+    for (auto& thread : threads)
+        thread.join();
+
+    if (error)
+        std::rethrow_exception(error);
+}
+
+}
@@ -16,6 +16,7 @@ struct RectMapping
     Size inputSize;
     Rect mappedRect;
     bool rotated = false;
+    int handle = -1; // dynamic packing only
 
     RectMapping() {}
     RectMapping(const Size& inputSize, int inputIndex)
@@ -0,0 +1,180 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Repack.h>
+#include <BinPacking.h>
+#include <FreeRectList.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace binpacking
+{
+
+static Rect Inflate(const Rect& rc, int amount)
+{
+    return Rect(rc.x - amount, rc.y - amount, rc.w + amount * 2, rc.h + amount * 2);
+}
+
+RepackResult Repack(
+    const std::vector<Bin>& previous,
+    const std::vector<Size>& sizes,
+    const std::vector<int>& previousIndex,
+    int maxSize,
+    int padding,
+    bool allowRotation)
+{
+    if (previousIndex.size() != sizes.size())
+        throw std::runtime_error("'previousIndex' must have one entry per size");
+
+    struct Placement
+    {
+        int bin = -1;
+        const RectMapping* mapping = nullptr;
+    };
+
+    std::vector<Placement> previousPlacements;
+
+    for (size_t b = 0; b < previous.size(); ++b)
+    {
+        for (auto& mapping : previous[b].mappings)
+        {
+            if (mapping.inputIndex < 0)
+                throw std::runtime_error("invalid input index in 'previous'");
+
+            if (mapping.inputIndex >= (int)previousPlacements.size())
+                previousPlacements.resize(mapping.inputIndex + 1);
+
+            if (previousPlacements[mapping.inputIndex].mapping)
+                throw std::runtime_error("'previous' has more than one mapping for an input");
+
+            previousPlacements[mapping.inputIndex] = { (int)b, &mapping };
+        }
+    }
+
+    RepackResult result;
+    std::vector<FreeRectList> freeLists;
+    std::vector<int> pending;
+    std::vector<uint8_t> claimed(previousPlacements.size());
+
+    result.bins.reserve(previous.size());
+    freeLists.reserve(previous.size());
+
+    for (auto& bin : previous)
+    {
+        result.bins.emplace_back(bin.size);
+        freeLists.emplace_back(bin.size);
+    }
+
+    for (int i = 0; i < (int)sizes.size(); ++i)
+    {
+        if (sizes[i].x > maxSize || sizes[i].y > maxSize)
+            throw std::runtime_error("all boxes must fit inside bounds 'maxSize'x'maxSize'");
+
+        int prev = previousIndex[i];
+        Placement placement;
+
+        if (prev >= 0 && prev < (int)previousPlacements.size())
+        {
+            if (claimed[prev])
+                throw std::runtime_error("'previousIndex' refers to the same input more than once");
+
+            claimed[prev] = 1;
+            placement = previousPlacements[prev];
+        }
+
+        if (!placement.mapping)
+        {
+            result.added.push_back(i);
+            pending.push_back(i);
+        }
+        else if (placement.mapping->inputSize.x != sizes[i].x ||
+                 placement.mapping->inputSize.y != sizes[i].y)
+        {
+            result.moved.push_back(i);
+            pending.push_back(i);
+        }
+        else
+        {
+            RectMapping mapping = *placement.mapping;
+            mapping.inputIndex = i;
+            result.bins[placement.bin].mappings.push_back(mapping);
+        }
+    }
+
+    // Kept rectangles are reserved from the top of each bin down. In input order they
+    // would be scattered, fragmenting the free space into many more rectangles.
+    std::vector<Rect> kept;
+
+    for (size_t b = 0; b < result.bins.size(); ++b)
+    {
+        kept.clear();
+
+        for (auto& mapping : result.bins[b].mappings)
+            kept.push_back(mapping.mappedRect);
+
+        std::sort(kept.begin(), kept.end(),
+            [](const Rect& a, const Rect& b) { return a.y != b.y ? a.y < b.y : a.x < b.x; });
+
+        for (auto& rc : kept)
+            freeLists[b].Reserve(Inflate(rc, padding));
+    }
+
+    std::stable_sort(pending.begin(), pending.end(),
+        [&](int a, int b) { return sizes[a].area() > sizes[b].area(); });
+
+    std::vector<Size> overflowSizes;
+    std::vector<int> overflowInputs;
+
+    for (int i : pending)
+    {
+        bool placed = false;
+
+        for (size_t b = 0; b < freeLists.size() && !placed; ++b)
+        {
+            Rect rc;
+            bool rotated;
+
+            if (freeLists[b].FindPosition(sizes[i], allowRotation, rc, rotated))
+            {
+                RectMapping mapping(sizes[i], i);
+                mapping.mappedRect = rc;
+                mapping.rotated = rotated;
+                result.bins[b].mappings.push_back(mapping);
+                freeLists[b].Reserve(Inflate(rc, padding));
+                placed = true;
+            }
+        }
+
+        if (!placed)
+        {
+            overflowSizes.push_back(sizes[i]);
+            overflowInputs.push_back(i);
+        }
+    }
+
+    while (!result.bins.empty() && result.bins.back().mappings.empty())
+        result.bins.pop_back();
+
+    if (!overflowSizes.empty())
+    {
+        BinPacker packer;
+        packer.PackBoxes(overflowSizes, maxSize, padding, allowRotation);
+
+        for (auto& bin : packer.GetBins())
+        {
+            result.bins.emplace_back(bin.size);
+
+            for (auto mapping : bin.mappings)
+            {
+                mapping.inputIndex = overflowInputs[mapping.inputIndex];
+                result.bins.back().mappings.push_back(mapping);
+            }
+        }
+    }
+
+    return result;
+}
+
+}
@@ -0,0 +1,36 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <Size.h>
+#include <Bin.h>
+
+namespace binpacking
+{
+
+struct RepackResult
+{
+    std::vector<Bin> bins;
+    std::vector<int> moved;  // inputs that had a placement, but got a new one
+    std::vector<int> added;  // inputs that had no previous placement
+};
+
+// Packs 'sizes' while keeping as many placements from 'previous' as possible.
+// 'previousIndex[i]' is the input index that input i had in 'previous', or -1 if it's new.
+// Each previous input can be claimed by at most one input.
+// Inputs whose size didn't change keep their bin and rectangle. The others are placed in
+// the free space of the existing bins, and whatever doesn't fit goes to new bins packed
+// with BinPacker::PackBoxes. Existing bins keep their index and size, even if they end up empty,
+// except for empty bins at the end.
+RepackResult Repack(
+    const std::vector<Bin>& previous,
+    const std::vector<Size>& sizes,
+    const std::vector<int>& previousIndex,
+    int maxSize,
+    int padding,
+    bool allowRotation = true);
+
+}
@@ -0,0 +1,228 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Trace.h>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <algorithm>
+#include <cstdio>
+#include <cinttypes>
+#include <stdexcept>
+
+namespace binpacking
+{
+
+struct TraceEvent
+{
+    const char* name;
+    const char* arg0;
+    const char* arg1;
+    int64_t value0;
+    int64_t value1;
+    int64_t begin;
+    int64_t end;
+};
+
+// Written only by its thread. Events are stored in fixed chunks that never move,
+// and published through 'count', so the buffer can be read while it's written.
+struct TraceBuffer
+{
+    constexpr static int ChunkSize = 4096;
+    constexpr static int MaxChunks = 1024;
+
+    int threadId = 0;
+    bool inUse = false; // guarded by buffersMutex
+    std::atomic<int> count { 0 };
+    std::unique_ptr<TraceEvent[]> chunks[MaxChunks];
+};
+
+namespace detail {
+    std::atomic<bool> tracingEnabled { false };
+}
+
+static std::mutex buffersMutex;
+static std::vector<std::unique_ptr<TraceBuffer>> buffers;
+static std::chrono::steady_clock::time_point epoch = std::chrono::steady_clock::now();
+
+static int nextThreadId = 0;
+
+// Hands the buffer back when its thread exits. Its events are kept until the trace is cleared,
+// and the next thread that needs a buffer appends to it instead of allocating a new one.
+struct TraceBufferOwner
+{
+    TraceBuffer* buffer = nullptr;
+
+    ~TraceBufferOwner()
+    {
+        if (buffer)
+        {
+            std::lock_guard<std::mutex> lock(buffersMutex);
+            buffer->inUse = false;
+            buffer = nullptr;
+        }
+    }
+};
+
+static TraceBuffer* GetThreadBuffer()
+{
+    thread_local TraceBufferOwner owner;
+
+    if (!owner.buffer)
+    {
+        std::lock_guard<std::mutex> lock(buffersMutex);
+
+        for (auto& buffer : buffers)
+        {
+            if (!buffer->inUse)
+            {
+                owner.buffer = buffer.get();
+                break;
+            }
+        }
+
+        if (!owner.buffer)
+        {
+            buffers.push_back(std::make_unique<TraceBuffer>());
+            owner.buffer = buffers.back().get();
+            owner.buffer->threadId = ++nextThreadId;
+        }
+
+        owner.buffer->inUse = true;
+    }
+
+    return owner.buffer;
+}
+
+int64_t detail::TraceNow()
+{
+    auto elapsed = std::chrono::steady_clock::now() - epoch;
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+}
+
+void detail::AddTraceEvent(const char* name, int64_t begin, int64_t end,
+    const char* arg0, int64_t value0, const char* arg1, int64_t value1)
+{
+    TraceBuffer* buffer = GetThreadBuffer();
+    int index = buffer->count.load(std::memory_order_relaxed);
+    int chunk = index / TraceBuffer::ChunkSize;
+
+    // drop events once the buffer is full
+    if (chunk >= TraceBuffer::MaxChunks)
+        return;
+
+    if (!buffer->chunks[chunk])
+        buffer->chunks[chunk].reset(new TraceEvent[TraceBuffer::ChunkSize]);
+
+    buffer->chunks[chunk][index % TraceBuffer::ChunkSize] =
+        TraceEvent{ name, arg0, arg1, value0, value1, begin, end };
+
+    buffer->count.store(index + 1, std::memory_order_release);
+}
+
+void StartTracing()
+{
+    ClearTrace();
+    epoch = std::chrono::steady_clock::now();
+    detail::tracingEnabled.store(true, std::memory_order_relaxed);
+}
+
+void StopTracing()
+{
+    detail::tracingEnabled.store(false, std::memory_order_relaxed);
+}
+
+void ClearTrace()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    // free the buffers of threads that exited, and empty the others
+    buffers.erase(std::remove_if(buffers.begin(), buffers.end(),
+        [](const std::unique_ptr<TraceBuffer>& buffer) { return !buffer->inUse; }),
+        buffers.end());
+
+    for (auto& buffer : buffers)
+        buffer->count.store(0, std::memory_order_relaxed);
+}
+
+static void AppendEscaped(std::string& out, const char* str)
+{
+    for ( ; *str; ++str)
+    {
+        if (*str == '"' || *str == '\\')
+            out += '\\';
+
+        out += *str;
+    }
+}
+
+std::string GetTraceJson()
+{
+    std::lock_guard<std::mutex> lock(buffersMutex);
+
+    std::string out = "{\"traceEvents\":[";
+    char number[128];
+    bool first = true;
+
+    for (auto& buffer : buffers)
+    {
+        int count = buffer->count.load(std::memory_order_acquire);
+
+        for (int i = 0; i < count; ++i)
+        {
+            auto& e = buffer->chunks[i / TraceBuffer::ChunkSize][i % TraceBuffer::ChunkSize];
+
+            if (!first) out += ',';
+            first = false;
+
+            out += "\n{\"name\":\"";
+            AppendEscaped(out, e.name);
+
+            snprintf(number, sizeof(number),
+                "\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f",
+                buffer->threadId, e.begin / 1000.0, (e.end - e.begin) / 1000.0);
+
+            out += number;
+
+            if (e.arg0)
+            {
+                out += ",\"args\":{\"";
+                AppendEscaped(out, e.arg0);
+                snprintf(number, sizeof(number), "\":%" PRId64, e.value0);
+                out += number;
+
+                if (e.arg1)
+                {
+                    out += ",\"";
+                    AppendEscaped(out, e.arg1);
+                    snprintf(number, sizeof(number), "\":%" PRId64, e.value1);
+                    out += number;
+                }
+
+                out += '}';
+            }
+
+            out += '}';
+        }
+    }
+
+    out += "\n]}\n";
+    return out;
+}
+
+void SaveTrace(const std::string& path)
+{
+    std::string json = GetTraceJson();
+
+    std::unique_ptr<FILE, int(*)(FILE*)> file(fopen(path.c_str(), "wb"), fclose);
+    if (!file)
+        throw std::runtime_error("failed to open '" + path + "' for writing");
+
+    if (fwrite(json.data(), 1, json.size(), file.get()) != json.size())
+        throw std::runtime_error("failed to write '" + path + "'");
+}
+
+}
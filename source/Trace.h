@@ -0,0 +1,78 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+namespace binpacking
+{
+
+// Records timed spans into per-thread buffers, and exports them as Chrome trace-event JSON
+// (chrome://tracing, ui.perfetto.dev). Tracing is off by default, and a disabled TraceScope
+// costs one relaxed atomic load.
+//
+// When a thread exits, its buffer is kept for its events and reused by the next thread
+// that records one. ClearTrace frees the buffers that no running thread holds.
+//
+// Start, stop and clear the trace only while no traced code is running.
+// The trace can be written at any time.
+void StartTracing();
+void StopTracing();
+void ClearTrace();
+std::string GetTraceJson();
+void SaveTrace(const std::string& path);
+
+namespace detail {
+    extern std::atomic<bool> tracingEnabled;
+    int64_t TraceNow();
+    void AddTraceEvent(const char* name, int64_t begin, int64_t end,
+        const char* arg0, int64_t value0, const char* arg1, int64_t value1);
+}
+
+inline bool IsTracing() {
+    return detail::tracingEnabled.load(std::memory_order_relaxed);
+}
+
+// Records a span from construction to destruction. 'name' and argument names
+// must be string literals, or otherwise outlive the trace.
+class TraceScope
+{
+    const char* name;
+    const char* arg0;
+    const char* arg1;
+    int64_t value0;
+    int64_t value1;
+    int64_t begin;
+
+public:
+    TraceScope(const char* name,
+        const char* arg0 = nullptr, int64_t value0 = 0,
+        const char* arg1 = nullptr, int64_t value1 = 0)
+        : name(nullptr), arg0(nullptr), arg1(nullptr), value0(0), value1(0), begin(0)
+    {
+        if (IsTracing())
+        {
+            this->name = name;
+            this->arg0 = arg0;
+            this->value0 = value0;
+            this->arg1 = arg1;
+            this->value1 = value1;
+            begin = detail::TraceNow();
+        }
+    }
+
+    ~TraceScope()
+    {
+        if (name)
+            detail::AddTraceEvent(name, begin, detail::TraceNow(), arg0, value0, arg1, value1);
+    }
+
+    TraceScope(const TraceScope&) = delete;
+    TraceScope& operator=(const TraceScope&) = delete;
+};
+
+}
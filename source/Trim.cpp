@@ -0,0 +1,168 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Trim.h>
+#include <ParallelFor.h>
+#include <Simd.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace binpacking
+{
+
+// Scans pixels [begin, end) of a row for alpha values above a threshold.
+class AlphaScanner
+{
+    int channels;
+    int alphaOffset;
+    uint8_t threshold;
+#if BINPACKING_SSE2
+    __m128i alphaMask;
+    __m128i thresholdMask;
+#endif
+
+    bool IsOpaque(const uint8_t* row, int x) const {
+        return row[x * channels + alphaOffset] > threshold;
+    }
+
+#if BINPACKING_SSE2
+    // bit i is set if byte i of the block is an alpha value above the threshold
+    int OpaqueBytes(const uint8_t* p) const
+    {
+        __m128i v = _mm_and_si128(_mm_loadu_si128((const __m128i*)p), alphaMask);
+        __m128i above = _mm_subs_epu8(v, thresholdMask);
+        return ~_mm_movemask_epi8(_mm_cmpeq_epi8(above, _mm_setzero_si128())) & 0xFFFF;
+    }
+#endif
+
+public:
+    AlphaScanner(int channels, uint8_t threshold)
+        : channels(channels), alphaOffset(channels - 1), threshold(threshold)
+    {
+#if BINPACKING_SSE2
+        if (channels == 4) {
+            alphaMask = _mm_set1_epi32((int)0xFF000000);
+            thresholdMask = _mm_set1_epi32((int)((uint32_t)threshold << 24));
+        }
+        else {
+            alphaMask = _mm_set1_epi8((char)0xFF);
+            thresholdMask = _mm_set1_epi8((char)threshold);
+        }
+#endif
+    }
+
+    // Returns the first opaque pixel in [begin, end), or 'end' if there are none.
+    int FindFirst(const uint8_t* row, int begin, int end) const
+    {
+        int x = begin;
+
+#if BINPACKING_SSE2
+        const int pixelsPerBlock = 16 / channels;
+
+        for ( ; x + pixelsPerBlock <= end; x += pixelsPerBlock)
+        {
+            int bits = OpaqueBytes(row + x * channels);
+            if (bits) {
+                int byte = 0;
+                while (!(bits & (1 << byte))) ++byte;
+                return x + byte / channels;
+            }
+        }
+#endif
+
+        for ( ; x < end; ++x)
+        {
+            if (IsOpaque(row, x))
+                return x;
+        }
+
+        return end;
+    }
+
+    // Returns the last opaque pixel in [begin, end), or begin - 1 if there are none.
+    int FindLast(const uint8_t* row, int begin, int end) const
+    {
+        int x = end;
+
+#if BINPACKING_SSE2
+        const int pixelsPerBlock = 16 / channels;
+
+        for ( ; x - pixelsPerBlock >= begin; x -= pixelsPerBlock)
+        {
+            int bits = OpaqueBytes(row + (x - pixelsPerBlock) * channels);
+            if (bits) {
+                int byte = 15;
+                while (!(bits & (1 << byte))) --byte;
+                return x - pixelsPerBlock + byte / channels;
+            }
+        }
+#endif
+
+        for ( ; x > begin; --x)
+        {
+            if (IsOpaque(row, x - 1))
+                return x - 1;
+        }
+
+        return begin - 1;
+    }
+};
+
+Rect FindOpaqueBounds(const ImageView& image, uint8_t alphaThreshold)
+{
+    if (image.channels != 1 && image.channels != 4)
+        throw std::runtime_error("images must have 1 or 4 channels");
+
+    if (image.width <= 0 || image.height <= 0)
+        return Rect();
+
+    AlphaScanner scanner(image.channels, alphaThreshold);
+    const int w = image.width;
+
+    int top = 0;
+    while (top < image.height && scanner.FindFirst(image.GetRow(top), 0, w) == w)
+        ++top;
+
+    if (top == image.height)
+        return Rect(0, 0, 1, 1);
+
+    int bottom = image.height - 1;
+    while (scanner.FindFirst(image.GetRow(bottom), 0, w) == w)
+        --bottom;
+
+    // each row only needs to be scanned outside of the bounds found so far
+    int left = w;
+    int right = -1;
+
+    for (int y = top; y <= bottom; ++y)
+    {
+        const uint8_t* row = image.GetRow(y);
+        left = scanner.FindFirst(row, 0, left);
+        right = std::max(right, scanner.FindLast(row, right + 1, w));
+    }
+
+    return Rect(left, top, right - left + 1, bottom - top + 1);
+}
+
+void TrimImages(
+    const std::vector<ImageView>& images,
+    std::vector<ImageView>& trimmedImages,
+    std::vector<TrimInfo>& trims,
+    uint8_t alphaThreshold,
+    int threadCount)
+{
+    trimmedImages.resize(images.size());
+    trims.resize(images.size());
+
+    ParallelFor((int)images.size(), threadCount, [&](int i) {
+        auto& image = images[i];
+        Rect bounds = FindOpaqueBounds(image, alphaThreshold);
+        trims[i].bounds = bounds;
+        trims[i].sourceSize = image.size();
+        trimmedImages[i] = image.SubView(bounds);
+    });
+}
+
+}
@@ -0,0 +1,39 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <Size.h>
+#include <Rect.h>
+#include <Image.h>
+
+namespace binpacking
+{
+
+// Where a trimmed image came from: 'bounds' is the part of the
+// source image that was kept, and 'sourceSize' is its original size.
+// A renderer places the packed image at (bounds.x, bounds.y) inside the original rectangle.
+struct TrimInfo
+{
+    Rect bounds;
+    Size sourceSize;
+};
+
+// Returns the smallest rectangle containing every pixel with an alpha greater than 'alphaThreshold'.
+// Single channel images are treated as alpha. Fully transparent images return a 1x1 rectangle.
+Rect FindOpaqueBounds(const ImageView& image, uint8_t alphaThreshold = 0);
+
+// Finds the opaque bounds of every image in parallel. 'trimmedImages' receives views of the
+// kept pixels, whose sizes can be passed to BinPacker::PackBoxes and whose views can be passed
+// to ComposeBin. 'trims' receives the information needed to restore the original placement.
+void TrimImages(
+    const std::vector<ImageView>& images,
+    std::vector<ImageView>& trimmedImages,
+    std::vector<TrimInfo>& trims,
+    uint8_t alphaThreshold = 0,
+    int threadCount = 0);
+
+}
@@ -0,0 +1,193 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Validate.h>
+#include <algorithm>
+#include <map>
+#include <tuple>
+
+namespace binpacking
+{
+
+struct SweepItem
+{
+    const RectMapping* mapping;
+    int x0, y0, x1, y1; // extended right and down by the padding
+};
+
+struct SweepEvent
+{
+    int x;
+    bool start;
+    int item;
+
+    bool operator<(const SweepEvent& other) const {
+        // rectangles are half-open, so ends come first
+        return std::tie(x, start, item) < std::tie(other.x, other.start, other.item);
+    }
+};
+
+// dynamic packing puts the bin index in inputIndex, and identifies boxes by handle
+static int GetInputId(const RectMapping& mapping)
+{
+    return mapping.handle >= 0 ? mapping.handle : mapping.inputIndex;
+}
+
+static bool SameRect(const Rect& a, const Rect& b)
+{
+    return a.x == b.x && a.y == b.y && a.w == b.w && a.h == b.h;
+}
+
+static void CheckOverlaps(
+    const Bin& bin, int binIndex, int padding, bool allowSharedRects,
+    size_t maxViolations, std::vector<LayoutViolation>& violations)
+{
+    std::vector<const RectMapping*> mappings;
+    mappings.reserve(bin.mappings.size());
+
+    for (auto& mapping : bin.mappings)
+    {
+        if (mapping.mappedRect.w > 0 && mapping.mappedRect.h > 0)
+            mappings.push_back(&mapping);
+    }
+
+    // An input mapped twice to the same place is already reported as a duplicate,
+    // and shared rectangles are only checked once, if they're allowed
+    std::sort(mappings.begin(), mappings.end(), [](const RectMapping* a, const RectMapping* b) {
+        const Rect& ra = a->mappedRect;
+        const Rect& rb = b->mappedRect;
+        return std::make_tuple(ra.x, ra.y, ra.w, ra.h, GetInputId(*a))
+             < std::make_tuple(rb.x, rb.y, rb.w, rb.h, GetInputId(*b));
+    });
+
+    mappings.erase(std::unique(mappings.begin(), mappings.end(),
+        [&](const RectMapping* a, const RectMapping* b) {
+            return SameRect(a->mappedRect, b->mappedRect)
+                && (allowSharedRects || GetInputId(*a) == GetInputId(*b));
+        }), mappings.end());
+
+    std::vector<SweepItem> items;
+    std::vector<SweepEvent> events;
+    items.reserve(mappings.size());
+    events.reserve(mappings.size() * 2);
+
+    for (auto mapping : mappings)
+    {
+        const Rect& rc = mapping->mappedRect;
+        int index = (int)items.size();
+        items.push_back({ mapping, rc.x, rc.y, rc.x + rc.w + padding, rc.y + rc.h + padding });
+        events.push_back({ rc.x, true, index });
+        events.push_back({ rc.x + rc.w + padding, false, index });
+    }
+
+    std::sort(events.begin(), events.end());
+
+    // intervals crossing the sweep line, keyed by top edge. They never overlap,
+    // because a rectangle that would overlap one is reported and left out.
+    std::map<int, int> active;
+
+    for (auto& e : events)
+    {
+        const SweepItem& item = items[e.item];
+
+        if (!e.start)
+        {
+            auto it = active.find(item.y0);
+            if (it != active.end() && it->second == e.item)
+                active.erase(it);
+
+            continue;
+        }
+
+        auto next = active.lower_bound(item.y0);
+        int other = -1;
+
+        if (next != active.end() && next->first < item.y1)
+            other = next->second;
+        else if (next != active.begin() && items[std::prev(next)->second].y1 > item.y0)
+            other = std::prev(next)->second;
+
+        if (other < 0)
+        {
+            active.emplace_hint(next, item.y0, e.item);
+            continue;
+        }
+
+        LayoutViolation v;
+        v.type = ViolationType::Overlap;
+        v.bin = binIndex;
+        v.inputIndex = GetInputId(*item.mapping);
+        v.rect = item.mapping->mappedRect;
+        v.otherInputIndex = GetInputId(*items[other].mapping);
+        v.otherRect = items[other].mapping->mappedRect;
+        violations.push_back(v);
+
+        if (violations.size() >= maxViolations)
+            return;
+    }
+}
+
+std::vector<LayoutViolation> ValidateLayout(
+    const std::vector<Bin>& bins,
+    int padding,
+    size_t maxViolations,
+    bool allowSharedRects)
+{
+    std::vector<LayoutViolation> violations;
+    std::vector<bool> seenInputs;
+
+    for (size_t b = 0; b < bins.size() && violations.size() < maxViolations; ++b)
+    {
+        auto& bin = bins[b];
+
+        for (auto& mapping : bin.mappings)
+        {
+            if (violations.size() >= maxViolations)
+                return violations;
+
+            const Rect& rc = mapping.mappedRect;
+            int id = GetInputId(mapping);
+            LayoutViolation v;
+            v.bin = (int)b;
+            v.inputIndex = id;
+            v.rect = rc;
+
+            int w = mapping.rotated ? mapping.inputSize.y : mapping.inputSize.x;
+            int h = mapping.rotated ? mapping.inputSize.x : mapping.inputSize.y;
+
+            if (rc.x < 0 || rc.y < 0 || rc.w < 0 || rc.h < 0
+                || rc.x + rc.w > bin.size.x || rc.y + rc.h > bin.size.y)
+            {
+                v.type = ViolationType::OutOfBounds;
+                violations.push_back(v);
+            }
+            else if (rc.w != w || rc.h != h)
+            {
+                v.type = ViolationType::SizeMismatch;
+                violations.push_back(v);
+            }
+            else if (id >= 0)
+            {
+                if (id >= (int)seenInputs.size())
+                    seenInputs.resize(id + 1);
+
+                if (seenInputs[id])
+                {
+                    v.type = ViolationType::DuplicateInput;
+                    violations.push_back(v);
+                }
+
+                seenInputs[id] = true;
+            }
+        }
+
+        if (violations.size() < maxViolations)
+            CheckOverlaps(bin, (int)b, padding, allowSharedRects, maxViolations, violations);
+    }
+
+    return violations;
+}
+
+}
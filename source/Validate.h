@@ -0,0 +1,43 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <cstddef>
+#include <Rect.h>
+#include <Bin.h>
+
+namespace binpacking
+{
+
+enum class ViolationType
+{
+    OutOfBounds,    // 'rect' isn't inside the bin
+    SizeMismatch,   // 'rect' doesn't match the input size, taking rotation into account
+    DuplicateInput, // 'inputIndex' is mapped more than once
+    Overlap         // 'rect' and 'otherRect' overlap, or are closer than the padding
+};
+
+struct LayoutViolation
+{
+    ViolationType type;
+    int bin = -1;
+    int inputIndex = -1;      // the box handle for dynamic packing results
+    int otherInputIndex = -1; // overlaps only
+    Rect rect;
+    Rect otherRect;           // overlaps only
+};
+
+// Checks a packing result in O(n log n) with a sweep line over each bin.
+// If 'allowSharedRects' is true, different inputs with identical rectangles are allowed
+// to share space, which is how ExpandDuplicates maps duplicate inputs.
+// Stops after 'maxViolations' violations. Returns an empty list if the layout is valid.
+std::vector<LayoutViolation> ValidateLayout(
+    const std::vector<Bin>& bins,
+    int padding,
+    size_t maxViolations = 16,
+    bool allowSharedRects = false);
+
+}
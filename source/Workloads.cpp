@@ -0,0 +1,268 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include <Workloads.h>
+#include <algorithm>
+#include <stdexcept>
+
+namespace binpacking
+{
+
+static const char* DistributionNames[] = {
+    "uniform", "normal", "powerlaw", "glyphs", "duplicated", "aspect", "nearmax"
+};
+
+static_assert(sizeof(DistributionNames) / sizeof(DistributionNames[0]) == (size_t)Distribution::Count,
+    "missing distribution name");
+
+// xoshiro256** seeded with splitmix64
+class Random
+{
+    uint64_t s[4];
+
+    static uint64_t Rotl(uint64_t x, int k) {
+        return (x << k) | (x >> (64 - k));
+    }
+
+public:
+    Random(uint64_t seed)
+    {
+        for (auto& word : s)
+        {
+            seed += 0x9E3779B97F4A7C15ull;
+            uint64_t z = seed;
+            z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+            z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+            word = z ^ (z >> 31);
+        }
+    }
+
+    uint64_t Next()
+    {
+        uint64_t result = Rotl(s[1] * 5, 7) * 9;
+        uint64_t t = s[1] << 17;
+        s[2] ^= s[0];
+        s[3] ^= s[1];
+        s[1] ^= s[2];
+        s[0] ^= s[3];
+        s[2] ^= t;
+        s[3] = Rotl(s[3], 45);
+        return result;
+    }
+
+    // in [lo, hi]
+    int Range(int lo, int hi) {
+        return lo + (int)(((Next() >> 32) * (uint64_t)(hi - lo + 1)) >> 32);
+    }
+
+    // Approximately normal with a standard deviation of 65536, as the sum of 12 uniform
+    // values (Irwin-Hall). It's cut off at 6 standard deviations, which doesn't matter here.
+    int64_t Normal()
+    {
+        int64_t sum = 0;
+
+        for (int i = 0; i < 12; ++i)
+            sum += (int64_t)(Next() >> 48);
+
+        return sum - 6 * 65536;
+    }
+};
+
+// Everything below is done in integer arithmetic, since floating point
+// results can differ between compilers (contraction, excess precision)
+
+// 'denominator' must be positive
+static int64_t DivRound(int64_t numerator, int64_t denominator)
+{
+    return numerator >= 0
+        ? (numerator + denominator / 2) / denominator
+        : -((-numerator + denominator / 2) / denominator);
+}
+
+static int Clamp(int64_t value, int minSize, int maxSize)
+{
+    return (int)std::min<int64_t>(maxSize, std::max<int64_t>(minSize, value));
+}
+
+static uint64_t CubeRoot(uint64_t value)
+{
+    uint64_t lo = 0;
+    uint64_t hi = 2642245; // cube root of 2^64, rounded up
+
+    // largest root with root^3 <= value
+    while (lo < hi)
+    {
+        uint64_t mid = (lo + hi + 1) / 2;
+
+        if (mid * mid * mid <= value)
+            lo = mid;
+        else
+            hi = mid - 1;
+    }
+
+    return lo;
+}
+
+const char* GetDistributionName(Distribution distribution)
+{
+    int index = (int)distribution;
+    return index >= 0 && index < (int)Distribution::Count ? DistributionNames[index] : "";
+}
+
+bool ParseDistribution(const std::string& name, Distribution& distribution)
+{
+    for (int i = 0; i < (int)Distribution::Count; ++i)
+    {
+        if (name == DistributionNames[i])
+        {
+            distribution = (Distribution)i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+std::vector<Size> GenerateSizes(
+    Distribution distribution,
+    int count,
+    int minSize,
+    int maxSize,
+    uint64_t seed)
+{
+    if (count < 0 || minSize < 1 || maxSize < minSize)
+        throw std::runtime_error("invalid workload parameters");
+
+    Random random(seed);
+    std::vector<Size> sizes;
+    sizes.reserve(count);
+
+    int range = maxSize - minSize;
+
+    switch (distribution)
+    {
+    case Distribution::Uniform:
+        for (int i = 0; i < count; ++i)
+        {
+            int w = random.Range(minSize, maxSize);
+            int h = random.Range(minSize, maxSize);
+            sizes.push_back(Size(w, h));
+        }
+        break;
+
+    case Distribution::Normal:
+    {
+        // mean in the middle of the range, and standard deviation of a sixth of it
+        auto sample = [&]() {
+            int64_t offset = DivRound(random.Normal() * range, 6 * 65536);
+            return Clamp(DivRound((int64_t)minSize + maxSize + offset * 2, 2), minSize, maxSize);
+        };
+
+        for (int i = 0; i < count; ++i)
+        {
+            int w = sample();
+            int h = sample();
+            sizes.push_back(Size(w, h));
+        }
+        break;
+    }
+    case Distribution::PowerLaw:
+    {
+        // Pareto side lengths with alpha 1.5, and aspect ratios between 1:2 and 2:1.
+        // The inverse CDF is minSize * v^(-2/3) for v in (0, 1], which with 16 bit v
+        // and a result with 10 fractional bits is the cube root of 2^62 / (v * 2^16)^2.
+        for (int i = 0; i < count; ++i)
+        {
+            uint64_t v = (random.Next() >> 48) + 1;
+            uint64_t scale = CubeRoot((1ull << 62) / (v * v));
+            int64_t side = std::min((int64_t)minSize * (int64_t)scale, (int64_t)maxSize * 2048);
+
+            // the square root of the aspect ratio is between 1 and sqrt(2), in 1/1024ths
+            int64_t stretch = random.Range(1024, 1448);
+            int64_t longSide = DivRound(side * stretch, 1024 * 1024);
+            int64_t shortSide = DivRound(side, stretch);
+
+            int w = Clamp(longSide, minSize, maxSize);
+            int h = Clamp(shortSide, minSize, maxSize);
+            sizes.push_back(random.Next() & 1 ? Size(w, h) : Size(h, w));
+        }
+        break;
+    }
+    case Distribution::Glyphs:
+    {
+        // each font size gets a run of glyphs, like a character set rendered at that size
+        const int glyphsPerFont = 96;
+
+        for (int i = 0; i < count; )
+        {
+            int lineHeight = random.Range(minSize, maxSize);
+
+            for (int g = 0; g < glyphsPerFont && i < count; ++g, ++i)
+            {
+                // 45% to 100% of the line height, and 30% to 90% as wide, in 1/10000ths
+                int64_t height = (int64_t)lineHeight * random.Range(4500, 10000);
+                int64_t width = height * random.Range(3000, 9000);
+                int w = Clamp(DivRound(width, 10000 * 10000), minSize, maxSize);
+                int h = Clamp(DivRound(height, 10000), minSize, maxSize);
+                sizes.push_back(Size(w, h));
+            }
+        }
+        break;
+    }
+    case Distribution::Duplicated:
+    {
+        // weights of 1 / (i + 1), with 20 fractional bits
+        int distinct = std::max(1, count / 100);
+        std::vector<Size> pool;
+        std::vector<uint64_t> cumulative;
+        uint64_t total = 0;
+
+        for (int i = 0; i < distinct; ++i)
+        {
+            pool.push_back(Size(random.Range(minSize, maxSize), random.Range(minSize, maxSize)));
+            total += (1u << 20) / (i + 1);
+            cumulative.push_back(total);
+        }
+
+        for (int i = 0; i < count; ++i)
+        {
+            uint64_t pick = ((random.Next() >> 32) * total) >> 32;
+            size_t index = std::upper_bound(cumulative.begin(), cumulative.end(), pick) - cumulative.begin();
+            sizes.push_back(pool[index]);
+        }
+        break;
+    }
+    case Distribution::ExtremeAspect:
+    {
+        int thinMax = std::min(maxSize, minSize + std::max(1, range / 16));
+
+        for (int i = 0; i < count; ++i)
+        {
+            int thin = random.Range(minSize, thinMax);
+            int thick = random.Range(minSize, maxSize);
+            sizes.push_back(random.Next() & 1 ? Size(thin, thick) : Size(thick, thin));
+        }
+        break;
+    }
+    case Distribution::NearMax:
+    {
+        int low = std::max(minSize, maxSize - range / 5);
+
+        for (int i = 0; i < count; ++i)
+        {
+            int w = random.Range(low, maxSize);
+            int h = random.Range(low, maxSize);
+            sizes.push_back(Size(w, h));
+        }
+        break;
+    }
+    default:
+        throw std::runtime_error("invalid distribution");
+    }
+
+    return sizes;
+}
+
+}
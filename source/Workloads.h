@@ -0,0 +1,42 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <Size.h>
+
+namespace binpacking
+{
+
+enum class Distribution
+{
+    Uniform,       // width and height uniform in [minSize, maxSize]
+    Normal,        // normal around the middle of the range, clamped
+    PowerLaw,      // sprite-like: mostly small, with a long tail of large ones
+    Glyphs,        // font-like: a few font sizes, glyphs narrower than they're tall
+    Duplicated,    // a small set of distinct sizes, picked with Zipf frequencies
+    ExtremeAspect, // thin strips, one side near minSize
+    NearMax,       // both sides in the top fifth of the range
+    Count
+};
+
+const char* GetDistributionName(Distribution distribution);
+
+// Returns false if 'name' doesn't match a distribution name.
+bool ParseDistribution(const std::string& name, Distribution& distribution);
+
+// Generates 'count' sizes in [minSize, maxSize]. The same arguments always produce the same
+// sizes on every platform, since the generator only uses integer arithmetic, and doesn't
+// rely on standard library distributions.
+std::vector<Size> GenerateSizes(
+    Distribution distribution,
+    int count,
+    int minSize,
+    int maxSize,
+    uint64_t seed);
+
+}
@@ -0,0 +1,178 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#include "PerfCounters.h"
+
+#ifdef __linux__
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#include <cstring>
+#include <utility>
+#endif
+
+#ifdef __linux__
+
+static int OpenCounter(uint32_t type, uint64_t config, int groupFd)
+{
+    perf_event_attr attr;
+    memset(&attr, 0, sizeof(attr));
+    attr.size = sizeof(attr);
+    attr.type = type;
+    attr.config = config;
+    attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+    attr.disabled = (groupFd < 0); // members follow the leader
+    attr.exclude_kernel = 1;
+    attr.exclude_hv = 1;
+
+    return (int)syscall(SYS_perf_event_open, &attr, 0, -1, groupFd, 0);
+}
+
+PerfCounters::PerfCounters()
+{
+    const uint64_t l1dReadMiss = PERF_COUNT_HW_CACHE_L1D
+        | (PERF_COUNT_HW_CACHE_OP_READ << 8)
+        | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+    const std::pair<uint32_t, uint64_t> events[NumCounters] = {
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+        { PERF_TYPE_HW_CACHE, l1dReadMiss },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+        { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+    };
+
+    // the first counter that opens leads the group, and the kernel
+    // refuses members that can't be scheduled along with the others
+    for (int i = 0; i < NumCounters; ++i)
+    {
+        fds[i] = OpenCounter(events[i].first, events[i].second, leader);
+        slots[i] = -1;
+
+        if (fds[i] >= 0)
+        {
+            if (leader < 0)
+                leader = fds[i];
+
+            slots[i] = groupSize++;
+        }
+    }
+}
+
+PerfCounters::~PerfCounters()
+{
+    // members first, the leader last
+    for (int i = NumCounters; i-- > 0; )
+    {
+        if (fds[i] >= 0)
+            close(fds[i]);
+    }
+}
+
+bool PerfCounters::ReadGroup(uint64_t& enabled, uint64_t& running, uint64_t* counts) const
+{
+    // nr, time_enabled, time_running, then one value per member
+    uint64_t data[3 + NumCounters];
+    size_t size = (3 + groupSize) * sizeof(uint64_t);
+
+    if (leader < 0 || read(leader, data, size) != (ssize_t)size || data[0] != (uint64_t)groupSize)
+        return false;
+
+    enabled = data[1];
+    running = data[2];
+    memcpy(counts, data + 3, groupSize * sizeof(uint64_t));
+    return true;
+}
+
+void PerfCounters::Start()
+{
+    if (leader < 0)
+        return;
+
+    // reset clears the counts, but not the times, so those are measured from here
+    uint64_t counts[NumCounters];
+    ioctl(leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+
+    if (!ReadGroup(startEnabled, startRunning, counts))
+        startEnabled = startRunning = 0;
+
+    ioctl(leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+PerfCounters::Values PerfCounters::Stop()
+{
+    Values values;
+    values.fill(-1);
+    runningFraction = 0;
+
+    if (leader < 0)
+        return values;
+
+    ioctl(leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+
+    uint64_t enabled, running;
+    uint64_t counts[NumCounters];
+
+    if (!ReadGroup(enabled, running, counts))
+        return values;
+
+    enabled -= startEnabled;
+    running -= startRunning;
+
+    // a group that never got scheduled has nothing to scale
+    if (running == 0)
+        return values;
+
+    runningFraction = enabled ? (double)running / enabled : 1.0;
+
+    for (int i = 0; i < NumCounters; ++i)
+    {
+        if (slots[i] >= 0)
+            values[i] = (int64_t)((double)counts[slots[i]] / runningFraction);
+    }
+
+    return values;
+}
+
+#else
+
+PerfCounters::PerfCounters() {
+    fds.fill(-1);
+    slots.fill(-1);
+}
+
+PerfCounters::~PerfCounters() {}
+
+void PerfCounters::Start() {}
+
+PerfCounters::Values PerfCounters::Stop()
+{
+    Values values;
+    values.fill(-1);
+    return values;
+}
+
+#endif
+
+bool PerfCounters::IsAvailable() const
+{
+    for (int fd : fds)
+    {
+        if (fd >= 0)
+            return true;
+    }
+
+    return false;
+}
+
+const char* PerfCounters::GetName(int counter)
+{
+    static const char* names[NumCounters] = {
+        "cycles", "instructions", "L1d-misses", "LLC-misses", "branch-misses"
+    };
+
+    return names[counter];
+}
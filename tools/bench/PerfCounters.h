@@ -0,0 +1,58 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+#pragma once
+#include <cstdint>
+#include <array>
+
+// Hardware counters for the calling thread, read with perf_event_open on Linux.
+// The counters are opened as one group, so they're always measured over the same time.
+// If the CPU has to multiplex them with other events, the counts are scaled up to the
+// full time, and GetRunningFraction reports how much of it was actually measured.
+// Counters the kernel or CPU doesn't provide (or any counter, on other platforms)
+// read as -1. Access may need kernel.perf_event_paranoid <= 2.
+class PerfCounters
+{
+public:
+    enum Counter
+    {
+        Cycles,
+        Instructions,
+        L1DMisses,
+        LLCMisses,
+        BranchMisses,
+        NumCounters
+    };
+
+    typedef std::array<int64_t, NumCounters> Values;
+
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters&) = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+
+    bool IsAvailable() const;
+    void Start();
+    Values Stop();
+
+    // Fraction of the time between the last Start and Stop that the counters were running.
+    double GetRunningFraction() const {
+        return runningFraction;
+    }
+
+    static const char* GetName(int counter);
+
+private:
+    std::array<int, NumCounters> fds;
+    std::array<int, NumCounters> slots; // position of each counter in a group read
+    int leader = -1;
+    int groupSize = 0;
+    uint64_t startEnabled = 0;
+    uint64_t startRunning = 0;
+    double runningFraction = 0;
+
+    bool ReadGroup(uint64_t& enabled, uint64_t& running, uint64_t* counts) const;
+};
@@ -0,0 +1,256 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+// Packing benchmarks.
+//
+// Runs each workload several times and reports the median time, the bin count, and
+// with -c, hardware counters averaged over the runs (Linux only). The run% column is the
+// lowest share of a run that the counters were scheduled; below 100, counts are scaled estimates.
+// Only the packing calls are measured, not the packer's construction and destruction.
+// Counters only count the calling thread, which does all the packing in these workloads.
+//
+// Build:
+//   g++ -O2 -std=c++17 -Isource source/*.cpp tools/bench/*.cpp -o bench -lpthread
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <BinPacking.h>
+#include <Workloads.h>
+#include "PerfCounters.h"
+
+using namespace std;
+using namespace binpacking;
+
+// Times a workload's packing calls, and counts them if 'perf' is set
+struct Measurement
+{
+    PerfCounters* perf = nullptr;
+    chrono::steady_clock::time_point start;
+    double ms = 0;
+    PerfCounters::Values values {};
+
+    void Start()
+    {
+        if (perf)
+            perf->Start();
+
+        start = chrono::steady_clock::now();
+    }
+
+    void Stop()
+    {
+        ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        if (perf)
+            values = perf->Stop();
+    }
+};
+
+struct Workload
+{
+    string name;
+    vector<Size> sizes;
+    function<int(const vector<Size>&, Measurement&)> run; // returns the bin count
+};
+
+static int RunStatic(const vector<Size>& sizes, Measurement& m)
+{
+    BinPacker packer;
+    m.Start();
+    packer.PackBoxes(sizes, 1024, 1, true);
+    m.Stop();
+    return (int)packer.GetBins().size();
+}
+
+static int RunStaticSmallBins(const vector<Size>& sizes, Measurement& m)
+{
+    BinPacker packer;
+    m.Start();
+    packer.PackBoxes(sizes, 256, 1, true);
+    m.Stop();
+    return (int)packer.GetBins().size();
+}
+
+static int RunStaticAdaptive(const vector<Size>& sizes, Measurement& m)
+{
+    BinPacker packer;
+    packer.SetAdaptiveOrdering(true, 8, 4);
+    m.Start();
+    packer.PackBoxes(sizes, 256, 1, true);
+    m.Stop();
+    return (int)packer.GetBins().size();
+}
+
+static int RunDynamic(const vector<Size>& sizes, Measurement& m)
+{
+    BinPacker packer;
+    packer.StartDynamicPacking(1024, 1, true);
+
+    m.Start();
+
+    for (auto& size : sizes)
+        packer.PackBox(size);
+
+    m.Stop();
+
+    return (int)packer.GetBins().size();
+}
+
+static int RunBatch(const vector<Size>& sizes, Measurement& m)
+{
+    BinPacker packer;
+    packer.StartDynamicPacking(1024, 1, true);
+    m.Start();
+    packer.PackBoxBatch(sizes);
+    m.Stop();
+    return (int)packer.GetBins().size();
+}
+
+static vector<Workload> CreateWorkloads(uint64_t seed)
+{
+    vector<Workload> workloads;
+
+    for (int count : { 500, 2000, 8000 })
+    {
+        auto sizes = GenerateSizes(Distribution::Uniform, count, 10, 70, seed);
+        string suffix = "-" + to_string(count);
+
+        workloads.push_back({ "static" + suffix, sizes, RunStatic });
+        workloads.push_back({ "dynamic" + suffix, sizes, RunDynamic });
+        workloads.push_back({ "batch" + suffix, sizes, RunBatch });
+    }
+
+    // many small bins, so that adaptive ordering has a history to prune with
+    auto sizes = GenerateSizes(Distribution::Uniform, 4000, 4, 40, seed);
+    workloads.push_back({ "static-small-bins", sizes, RunStaticSmallBins });
+    workloads.push_back({ "adaptive-small-bins", sizes, RunStaticAdaptive });
+
+    for (int d = 0; d < (int)Distribution::Count; ++d)
+    {
+        auto distribution = (Distribution)d;
+        int maxBox = distribution == Distribution::NearMax ? 600 : 96;
+        sizes = GenerateSizes(distribution, 2000, 2, maxBox, seed);
+        workloads.push_back({ string("static-") + GetDistributionName(distribution), sizes, RunStatic });
+    }
+
+    return workloads;
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: bench [options] [filter]\n"
+        "  -n runs   runs per workload (default 5)\n"
+        "  -s seed   random seed (default 1)\n"
+        "  -c        collect hardware counters, for the calling thread only\n"
+        "  filter    only run workloads whose name contains this\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int runs = 5;
+    uint64_t seed = 1;
+    bool counters = false;
+    const char* filter = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-n" && hasValue) runs = max(1, atoi(argv[++i]));
+        else if (arg == "-s" && hasValue) seed = strtoull(argv[++i], nullptr, 10);
+        else if (arg == "-c") counters = true;
+        else if (arg == "-h" || arg == "--help") { PrintUsage(); return 0; }
+        else if (arg[0] != '-' && !filter) filter = argv[i];
+        else { PrintUsage(); return 1; }
+    }
+
+    PerfCounters perf;
+
+    if (counters && !perf.IsAvailable())
+    {
+        fprintf(stderr, "bench: hardware counters aren't available, check kernel.perf_event_paranoid\n");
+        counters = false;
+    }
+
+    if (counters)
+        printf("hardware counters cover the calling thread only\n");
+
+    printf("%-16s %10s %6s", "workload", "ms", "bins");
+
+    if (counters)
+    {
+        for (int c = 0; c < PerfCounters::NumCounters; ++c)
+            printf(" %14s", PerfCounters::GetName(c));
+
+        printf(" %6s %6s", "IPC", "run%");
+    }
+
+    printf("\n");
+
+    for (auto& workload : CreateWorkloads(seed))
+    {
+        if (filter && workload.name.find(filter) == string::npos)
+            continue;
+
+        vector<double> times;
+        PerfCounters::Values totals {};
+        double running = 1.0; // lowest fraction of a run that the counters measured
+        int bins = 0;
+
+        for (int r = 0; r < runs; ++r)
+        {
+            Measurement measurement;
+            measurement.perf = counters ? &perf : nullptr;
+
+            bins = workload.run(workload.sizes, measurement);
+
+            if (counters)
+            {
+                auto& values = measurement.values;
+
+                for (int c = 0; c < PerfCounters::NumCounters; ++c)
+                    totals[c] = (values[c] < 0 || totals[c] < 0) ? -1 : totals[c] + values[c];
+
+                running = min(running, perf.GetRunningFraction());
+            }
+
+            times.push_back(measurement.ms);
+        }
+
+        sort(times.begin(), times.end());
+        printf("%-16s %10.3f %6d", workload.name.c_str(), times[times.size() / 2], bins);
+
+        if (counters)
+        {
+            for (int c = 0; c < PerfCounters::NumCounters; ++c)
+            {
+                if (totals[c] < 0)
+                    printf(" %14s", "n/a");
+                else
+                    printf(" %14lld", (long long)(totals[c] / runs));
+            }
+
+            if (totals[PerfCounters::Cycles] > 0 && totals[PerfCounters::Instructions] >= 0)
+                printf(" %6.2f", (double)totals[PerfCounters::Instructions] / totals[PerfCounters::Cycles]);
+            else
+                printf(" %6s", "n/a");
+
+            // below 100, the counts were multiplexed with other events and are scaled estimates
+            printf(" %6.1f", running * 100.0);
+        }
+
+        printf("\n");
+    }
+
+    return 0;
+}
@@ -0,0 +1,423 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+// Command line packer.
+//
+// Reads one box per line from a file or stdin ("w h", "w,h", or "w x h"),
+// packs them, and writes one line per box in input order: "bin x y w h rotated".
+// Blank lines, lines starting with '#', and a CSV header on the first line are skipped.
+// Any other line must hold exactly two positive integers, or it's an error.
+// Empty input is an error too.
+// With -g, boxes are generated from a synthetic distribution instead.
+//
+// Build:
+//   g++ -O2 -std=c++17 -Isource source/*.cpp tools/binpack/main.cpp -o binpack
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <climits>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <BinPacking.h>
+#include <FlatLayout.h>
+#include <Workloads.h>
+
+using namespace std;
+using namespace binpacking;
+
+class InputReader
+{
+    FILE* file;
+    vector<char> buffer;
+    size_t pos = 0;
+    size_t end = 0;
+    bool eof = false;
+    int line = 0;
+
+    bool Fill()
+    {
+        if (eof)
+            return false;
+
+        size_t remaining = end - pos;
+        memmove(buffer.data(), buffer.data() + pos, remaining);
+        pos = 0;
+        end = remaining;
+
+        size_t n = fread(buffer.data() + end, 1, buffer.size() - end, file);
+        end += n;
+        eof = (n == 0);
+        return n > 0;
+    }
+
+    bool HasLine()
+    {
+        // make sure a complete line (or the rest of the file) is buffered
+        while (!memchr(buffer.data() + pos, '\n', end - pos))
+        {
+            if (end - pos == buffer.size())
+                buffer.resize(buffer.size() * 2);
+
+            if (!Fill())
+                return pos < end;
+        }
+
+        return true;
+    }
+
+    static bool IsDigit(char c) {
+        return c >= '0' && c <= '9';
+    }
+
+    static bool IsSpace(char c) {
+        return c == ' ' || c == '\t' || c == '\r';
+    }
+
+    static bool IsLetter(char c) {
+        return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z');
+    }
+
+    int ReadSide(const char*& p, const char* lineEnd)
+    {
+        if (p < lineEnd && *p == '-')
+            throw runtime_error("negative size on line " + to_string(line));
+
+        if (p == lineEnd || !IsDigit(*p))
+            throw runtime_error("expected a width and height on line " + to_string(line));
+
+        int v = 0;
+        while (p < lineEnd && IsDigit(*p))
+        {
+            int digit = *p++ - '0';
+            if (v > (INT_MAX - digit) / 10)
+                throw runtime_error("number too large on line " + to_string(line));
+
+            v = v * 10 + digit;
+        }
+
+        return v;
+    }
+
+public:
+    InputReader(FILE* file)
+        : file(file), buffer(1 << 20) {}
+
+    int GetLine() const {
+        return line;
+    }
+
+    // Returns false at the end of the input.
+    bool ReadBox(Size& box)
+    {
+        while (HasLine())
+        {
+            const char* p = buffer.data() + pos;
+            const char* lineEnd = (const char*)memchr(p, '\n', end - pos);
+            if (!lineEnd)
+                lineEnd = buffer.data() + end;
+
+            pos = lineEnd - buffer.data() + (lineEnd < buffer.data() + end ? 1 : 0);
+            ++line;
+
+            while (p < lineEnd && IsSpace(*p))
+                ++p;
+
+            if (p == lineEnd || *p == '#' || (line == 1 && IsLetter(*p)))
+                continue;
+
+            int width = ReadSide(p, lineEnd);
+
+            while (p < lineEnd && IsSpace(*p))
+                ++p;
+
+            if (p < lineEnd && (*p == ',' || *p == 'x' || *p == 'X'))
+                ++p;
+
+            while (p < lineEnd && IsSpace(*p))
+                ++p;
+
+            int height = ReadSide(p, lineEnd);
+
+            while (p < lineEnd && IsSpace(*p))
+                ++p;
+
+            if (p != lineEnd)
+                throw runtime_error("unexpected '" + string(1, *p) + "' on line " + to_string(line));
+
+            if (width == 0 || height == 0)
+                throw runtime_error("box with zero width or height on line " + to_string(line));
+
+            box = Size(width, height);
+            return true;
+        }
+
+        return false;
+    }
+};
+
+class OutputWriter
+{
+    FILE* file;
+    vector<char> buffer;
+    size_t pos = 0;
+
+    void WriteInt(int value)
+    {
+        char tmp[12];
+        int n = 0;
+        unsigned int v = value < 0 ? 0u - (unsigned int)value : (unsigned int)value;
+
+        do {
+            tmp[n++] = (char)('0' + v % 10);
+            v /= 10;
+        } while (v);
+
+        if (value < 0)
+            buffer[pos++] = '-';
+
+        while (n)
+            buffer[pos++] = tmp[--n];
+    }
+
+public:
+    OutputWriter(FILE* file)
+        : file(file), buffer(1 << 20) {}
+
+    // Buffered output is only written by Flush, which must be called
+    // explicitly since a write error can't be reported from a destructor.
+    void Flush()
+    {
+        if (pos && fwrite(buffer.data(), 1, pos, file) != pos)
+            throw runtime_error("failed to write output");
+
+        pos = 0;
+    }
+
+    void WriteMapping(int bin, const RectMapping& mapping)
+    {
+        // 6 numbers of at most 11 characters, plus separators
+        if (buffer.size() - pos < 80)
+            Flush();
+
+        auto& rc = mapping.mappedRect;
+        WriteInt(bin); buffer[pos++] = ' ';
+        WriteInt(rc.x); buffer[pos++] = ' ';
+        WriteInt(rc.y); buffer[pos++] = ' ';
+        WriteInt(rc.w); buffer[pos++] = ' ';
+        WriteInt(rc.h); buffer[pos++] = ' ';
+        buffer[pos++] = mapping.rotated ? '1' : '0';
+        buffer[pos++] = '\n';
+    }
+
+    void WriteBytes(const void* data, size_t size)
+    {
+        Flush();
+        if (size && fwrite(data, 1, size, file) != size)
+            throw runtime_error("failed to write output");
+    }
+};
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: binpack [options] [input]\n"
+        "  input          file to read boxes from, or - for stdin (default stdin)\n"
+        "  -m <size>      max bin size, power of two (default 1024)\n"
+        "  -p <padding>   padding between boxes (default 0)\n"
+        "  -d             dynamic mode: fixed size bins, boxes packed as they're read\n"
+        "  -r             don't rotate boxes\n"
+        "  -f text|flat   output format (default text)\n"
+        "  -o <file>      output file (default stdout)\n"
+        "  -g <dist>[:<count>[:<seed>]]\n"
+        "                 generate boxes instead of reading them (default 1000 boxes, seed 1)\n"
+        "                 dist: uniform, normal, powerlaw, glyphs, duplicated, aspect, nearmax\n"
+        "  -b <min>,<max> side length range of generated boxes (default 1 to max bin size / 8)\n");
+}
+
+int main(int argc, char* argv[])
+{
+    int maxSize = 1024;
+    int padding = 0;
+    bool dynamic = false;
+    bool allowRotation = true;
+    bool flat = false;
+    const char* inputPath = nullptr;
+    const char* outputPath = nullptr;
+    const char* generate = nullptr;
+    int minBox = 1;
+    int maxBox = 0;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-m" && hasValue) maxSize = atoi(argv[++i]);
+        else if (arg == "-p" && hasValue) padding = atoi(argv[++i]);
+        else if (arg == "-o" && hasValue) outputPath = argv[++i];
+        else if (arg == "-f" && hasValue) {
+            string format = argv[++i];
+            if (format == "flat") flat = true;
+            else if (format == "text") flat = false;
+            else { PrintUsage(); return 1; }
+        }
+        else if (arg == "-g" && hasValue) generate = argv[++i];
+        else if (arg == "-b" && hasValue) {
+            if (sscanf(argv[++i], "%d,%d", &minBox, &maxBox) != 2) { PrintUsage(); return 1; }
+        }
+        else if (arg == "-d") dynamic = true;
+        else if (arg == "-r") allowRotation = false;
+        else if (arg == "-h" || arg == "--help") { PrintUsage(); return 0; }
+        else if ((arg == "-" || arg[0] != '-') && !inputPath) inputPath = argv[i];
+        else { PrintUsage(); return 1; }
+    }
+
+    if (padding < 0) {
+        fprintf(stderr, "binpack: padding can't be negative\n");
+        return 1;
+    }
+
+    if (inputPath && strcmp(inputPath, "-") == 0)
+        inputPath = nullptr;
+
+    unique_ptr<FILE, int(*)(FILE*)> inputFile(nullptr, fclose);
+    unique_ptr<FILE, int(*)(FILE*)> outputFile(nullptr, fclose);
+
+    if (inputPath)
+    {
+        inputFile.reset(fopen(inputPath, "rb"));
+        if (!inputFile) {
+            fprintf(stderr, "binpack: failed to open '%s'\n", inputPath);
+            return 1;
+        }
+    }
+
+    if (outputPath)
+    {
+        outputFile.reset(fopen(outputPath, "wb"));
+        if (!outputFile) {
+            fprintf(stderr, "binpack: failed to open '%s'\n", outputPath);
+            return 1;
+        }
+    }
+
+    try
+    {
+        InputReader reader(inputFile ? inputFile.get() : stdin);
+        OutputWriter writer(outputFile ? outputFile.get() : stdout);
+        BinPacker packer;
+        Size box;
+
+        vector<Size> generated;
+        size_t nextGenerated = 0;
+
+        if (generate)
+        {
+            char name[32] = {};
+            int count = 1000;
+            unsigned long long seed = 1;
+            Distribution distribution;
+
+            if (sscanf(generate, "%31[^:]:%d:%llu", name, &count, &seed) < 1 || !ParseDistribution(name, distribution))
+                throw runtime_error(string("invalid distribution '") + generate + "'");
+
+            if (maxBox <= 0)
+                maxBox = max(1, maxSize / 8);
+
+            generated = GenerateSizes(distribution, count, minBox, maxBox, seed);
+        }
+
+        auto readBox = [&](Size& next) {
+            if (!generate)
+                return reader.ReadBox(next);
+
+            if (nextGenerated == generated.size())
+                return false;
+
+            next = generated[nextGenerated++];
+            return true;
+        };
+
+        if (dynamic)
+        {
+            packer.StartDynamicPacking(maxSize, padding, allowRotation);
+
+            // handles are assigned in input order, so the results can be written as they come
+            size_t count = 0;
+            for ( ; readBox(box); ++count)
+            {
+                auto mapping = packer.PackBox(box);
+                if (!flat)
+                    writer.WriteMapping(mapping.inputIndex, mapping);
+            }
+
+            if (count == 0)
+                throw runtime_error("no boxes in input");
+
+            if (flat)
+            {
+                vector<Bin> bins;
+                for (auto& bin : packer.GetBins())
+                {
+                    bins.emplace_back(bin.size);
+                    for (auto& mapping : bin.mappings)
+                    {
+                        bins.back().mappings.push_back(mapping);
+                        bins.back().mappings.back().inputIndex = mapping.handle;
+                    }
+                }
+
+                vector<uint8_t> data;
+                WriteFlatLayout(bins, data);
+                writer.WriteBytes(data.data(), data.size());
+            }
+        }
+        else
+        {
+            vector<Size> boxes;
+            while (readBox(box))
+                boxes.push_back(box);
+
+            if (boxes.empty())
+                throw runtime_error("no boxes in input");
+
+            packer.PackBoxes(boxes, maxSize, padding, allowRotation);
+
+            if (flat)
+            {
+                vector<uint8_t> data;
+                WriteFlatLayout(packer.GetBins(), data);
+                writer.WriteBytes(data.data(), data.size());
+            }
+            else
+            {
+                vector<pair<int, const RectMapping*>> results(boxes.size());
+
+                auto& bins = packer.GetBins();
+                for (size_t b = 0; b < bins.size(); ++b)
+                {
+                    for (auto& mapping : bins[b].mappings)
+                        results[mapping.inputIndex] = { (int)b, &mapping };
+                }
+
+                for (auto& result : results)
+                    writer.WriteMapping(result.first, *result.second);
+            }
+        }
+
+        writer.Flush();
+    }
+    catch (exception& ex)
+    {
+        fprintf(stderr, "binpack: %s\n", ex.what());
+        return 1;
+    }
+
+    return 0;
+}
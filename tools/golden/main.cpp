@@ -0,0 +1,277 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+// Golden result regression runner.
+//
+// Packs every case of a corpus file and compares the bin count and fill ratio against
+// the recorded results. Fails if a case needs more bins, loses more fill than the threshold,
+// or produces an invalid layout. Bin size changes and improvements are reported, but don't fail.
+// Run with -u to record the current results.
+//
+// Each corpus line describes a generated input and its recorded result:
+//   name distribution count minSize maxSize seed binSize padding rotation mode  bins fill sizes ms
+// where mode is 'static' or 'dynamic', sizes is a comma separated list of WxH or WxH*N bin sizes,
+// and ms is the runtime when the line was recorded, for reference only.
+//
+// Build:
+//   g++ -O2 -std=c++17 -Isource source/*.cpp tools/golden/main.cpp -o golden -lpthread
+//   ./golden tools/golden/corpus.txt
+
+#include <cstdio>
+#include <cstdlib>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <sstream>
+#include <fstream>
+#include <stdexcept>
+#include <BinPacking.h>
+#include <Workloads.h>
+#include <Validate.h>
+
+using namespace std;
+using namespace binpacking;
+
+struct GoldenCase
+{
+    string name;
+    string distribution;
+    int count = 0;
+    int minSize = 0;
+    int maxSize = 0;
+    uint64_t seed = 0;
+    int binSize = 0;
+    int padding = 0;
+    int rotation = 1;
+    string mode;
+
+    // recorded result, if any
+    int bins = -1;
+    double fill = 0;
+    string sizes;
+    double ms = 0;
+};
+
+struct GoldenResult
+{
+    int bins = 0;
+    double fill = 0;
+    string sizes;
+    double ms = 0;
+    bool valid = true;
+};
+
+static vector<GoldenCase> ReadCorpus(const string& path, vector<string>& lines)
+{
+    ifstream file(path);
+    if (!file)
+        throw runtime_error("failed to open '" + path + "'");
+
+    vector<GoldenCase> cases;
+    string line;
+
+    while (getline(file, line))
+    {
+        lines.push_back(line);
+
+        if (line.empty() || line[0] == '#')
+            continue;
+
+        istringstream in(line);
+        GoldenCase c;
+
+        if (!(in >> c.name >> c.distribution >> c.count >> c.minSize >> c.maxSize
+                 >> c.seed >> c.binSize >> c.padding >> c.rotation >> c.mode))
+            throw runtime_error("invalid corpus line: " + line);
+
+        if (!(in >> c.bins >> c.fill >> c.sizes >> c.ms))
+            c.bins = -1;
+
+        cases.push_back(c);
+    }
+
+    return cases;
+}
+
+static string FormatCase(const GoldenCase& c, const GoldenResult& r)
+{
+    char buffer[256];
+    snprintf(buffer, sizeof(buffer), "%s %s %d %d %d %llu %d %d %d %s",
+        c.name.c_str(), c.distribution.c_str(), c.count, c.minSize, c.maxSize,
+        (unsigned long long)c.seed, c.binSize, c.padding, c.rotation, c.mode.c_str());
+
+    string line = buffer;
+    snprintf(buffer, sizeof(buffer), "  %d %.6f ", r.bins, r.fill);
+    line += buffer;
+    line += r.sizes;
+    snprintf(buffer, sizeof(buffer), " %.1f", r.ms);
+    line += buffer;
+    return line;
+}
+
+static GoldenResult Run(const GoldenCase& c)
+{
+    Distribution distribution;
+    if (!ParseDistribution(c.distribution, distribution))
+        throw runtime_error("unknown distribution '" + c.distribution + "' in case " + c.name);
+
+    auto sizes = GenerateSizes(distribution, c.count, c.minSize, c.maxSize, c.seed);
+    BinPacker packer;
+
+    auto start = chrono::steady_clock::now();
+
+    if (c.mode == "static")
+    {
+        packer.PackBoxes(sizes, c.binSize, c.padding, c.rotation != 0);
+    }
+    else if (c.mode == "dynamic")
+    {
+        packer.StartDynamicPacking(c.binSize, c.padding, c.rotation != 0);
+
+        for (auto& size : sizes)
+            packer.PackBox(size);
+    }
+    else
+    {
+        throw runtime_error("unknown mode '" + c.mode + "' in case " + c.name);
+    }
+
+    GoldenResult result;
+    result.ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+    auto& bins = packer.GetBins();
+    result.bins = (int)bins.size();
+    result.fill = packer.GetMetrics().total.occupancy;
+    result.valid = ValidateLayout(bins, c.padding, 1).empty();
+
+    // runs of equal sizes are written as WxH*N
+    for (size_t b = 0; b < bins.size(); )
+    {
+        size_t end = b + 1;
+        while (end < bins.size() && bins[end].size.x == bins[b].size.x && bins[end].size.y == bins[b].size.y)
+            ++end;
+
+        if (!result.sizes.empty())
+            result.sizes += ',';
+
+        result.sizes += to_string(bins[b].size.x) + "x" + to_string(bins[b].size.y);
+
+        if (end - b > 1)
+            result.sizes += "*" + to_string(end - b);
+
+        b = end;
+    }
+
+    return result;
+}
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: golden [options] corpus\n"
+        "  -t fill    allowed fill ratio loss (default 0.002)\n"
+        "  -u         record the current results in the corpus\n"
+        "  filter     only run cases whose name contains this\n");
+}
+
+int main(int argc, char* argv[])
+{
+    double threshold = 0.002;
+    bool update = false;
+    const char* corpusPath = nullptr;
+    const char* filter = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-t" && hasValue) threshold = atof(argv[++i]);
+        else if (arg == "-u") update = true;
+        else if (arg == "-h" || arg == "--help") { PrintUsage(); return 0; }
+        else if (arg[0] != '-' && !corpusPath) corpusPath = argv[i];
+        else if (arg[0] != '-' && !filter) filter = argv[i];
+        else { PrintUsage(); return 1; }
+    }
+
+    if (!corpusPath) {
+        PrintUsage();
+        return 1;
+    }
+
+    try
+    {
+        vector<string> lines;
+        auto cases = ReadCorpus(corpusPath, lines);
+        int failures = 0;
+
+        printf("%-20s %12s %18s %10s  %s\n", "case", "bins", "fill", "ms", "status");
+
+        size_t caseIndex = 0;
+
+        for (auto& line : lines)
+        {
+            if (line.empty() || line[0] == '#')
+                continue;
+
+            auto& c = cases[caseIndex++];
+
+            if (filter && c.name.find(filter) == string::npos)
+                continue;
+
+            GoldenResult r = Run(c);
+            string status;
+
+            if (!r.valid)
+                status = "FAIL: invalid layout";
+            else if (c.bins < 0)
+                status = "not recorded";
+            else if (r.bins > c.bins)
+                status = "FAIL: more bins";
+            else if (r.fill < c.fill - threshold)
+                status = "FAIL: lower fill";
+            else if (r.bins < c.bins || r.fill > c.fill + threshold)
+                status = "improved";
+            else if (r.sizes != c.sizes)
+                status = "ok, bin sizes changed";
+            else
+                status = "ok";
+
+            if (status.compare(0, 4, "FAIL") == 0)
+                ++failures;
+
+            char bins[32], fill[32];
+            snprintf(bins, sizeof(bins), "%d -> %d", c.bins, r.bins);
+            snprintf(fill, sizeof(fill), "%.4f -> %.4f", c.fill, r.fill);
+            printf("%-20s %12s %18s %10.1f  %s\n", c.name.c_str(), bins, fill, r.ms, status.c_str());
+
+            if (update && r.valid)
+                line = FormatCase(c, r);
+        }
+
+        if (update)
+        {
+            ofstream file(corpusPath, ios::trunc);
+            for (auto& line : lines)
+                file << line << '\n';
+
+            if (!file)
+                throw runtime_error(string("failed to write '") + corpusPath + "'");
+        }
+
+        if (failures)
+        {
+            printf("%d regression(s)\n", failures);
+            return 1;
+        }
+    }
+    catch (const exception& e)
+    {
+        fprintf(stderr, "golden: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,275 @@
+/*---------------------------------------------------------------------------------------------
+*  Copyright (c) 2020 Nicolas Jinchereau. All rights reserved.
+*  Licensed under the MIT License. See License.txt in the project root for license information.
+*--------------------------------------------------------------------------------------------*/
+
+// Dynamic trace replay.
+//
+// Re-executes a trace written by DynamicTraceRecorder and reports latency
+// percentiles per operation type, plus the final bin count.
+// With the default engine, the handles assigned by each pack are checked against the trace,
+// and the replay stops if they differ, since later frees would then hit the wrong boxes.
+// That can happen when -s, -p, -r or -R change which single-bin transactions succeed.
+//
+// Build:
+//   g++ -O2 -std=c++17 -Isource source/*.cpp tools/replay/main.cpp -o replay -lpthread
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <chrono>
+#include <vector>
+#include <string>
+#include <memory>
+#include <algorithm>
+#include <stdexcept>
+#include <BinPacking.h>
+#include <ConcurrentBinPacker.h>
+#include <DynamicTrace.h>
+#include <MappedFile.h>
+
+using namespace std;
+using namespace binpacking;
+
+static const char* OpNames[] = {
+    "", "start", "pack", "free", "batch", "single-bin", "compact"
+};
+
+constexpr int NumOpTypes = 7;
+
+struct Options
+{
+    bool concurrent = false;
+    int binSize = 0;       // 0 keeps the traced value
+    int padding = -1;      // -1 keeps the traced value
+    int rotation = -1;     // -1 keeps the traced value
+};
+
+static void PrintUsage()
+{
+    fprintf(stderr,
+        "usage: replay [options] trace\n"
+        "  -e engine   'packer' (default) or 'concurrent'\n"
+        "  -s size     override the bin size\n"
+        "  -p padding  override the box padding\n"
+        "  -r          disable rotation\n"
+        "  -R          enable rotation\n");
+}
+
+// Runs 'ops' and stores the duration of each one in nanoseconds, by type.
+// Returns the final bin count.
+template<class Engine>
+static int Replay(const vector<DynamicOp>& ops, const Options& options,
+    vector<vector<int64_t>>& latencies, int& skipped)
+{
+    using clock = chrono::steady_clock;
+    Engine engine;
+
+    for (size_t i = 0; i < ops.size(); ++i)
+    {
+        auto& op = ops[i];
+        DynamicOp effective = op;
+
+        if (op.type == DynamicOpType::Start)
+        {
+            if (options.binSize > 0) effective.size = Size(options.binSize, options.binSize);
+            if (options.padding >= 0) effective.padding = options.padding;
+            if (options.rotation >= 0) effective.allowRotation = options.rotation != 0;
+        }
+
+        auto start = clock::now();
+        bool ran = false;
+
+        try {
+            ran = engine.Run(effective);
+        }
+        catch (const exception& e) {
+            throw runtime_error("operation " + to_string(i) + " (" + OpNames[(int)op.type] + "): " + e.what());
+        }
+
+        if (!ran) {
+            ++skipped;
+            continue;
+        }
+
+        auto elapsed = chrono::duration_cast<chrono::nanoseconds>(clock::now() - start).count();
+        latencies[(int)op.type].push_back(elapsed);
+    }
+
+    return engine.GetBinCount();
+}
+
+struct PackerEngine
+{
+    BinPacker packer;
+
+    static void CheckHandle(const DynamicOp& op, int handle)
+    {
+        if (handle != op.handle)
+        {
+            throw runtime_error("replay diverged from the trace: expected handle "
+                + to_string(op.handle) + ", got " + to_string(handle));
+        }
+    }
+
+    static int FirstHandle(const vector<RectMapping>& mappings) {
+        return mappings.empty() ? -1 : mappings[0].handle;
+    }
+
+    bool Run(const DynamicOp& op)
+    {
+        switch (op.type)
+        {
+        case DynamicOpType::Start:
+            packer.StartDynamicPacking(op.size.x, op.padding, op.allowRotation);
+            break;
+
+        case DynamicOpType::PackBox:
+            CheckHandle(op, packer.PackBox(op.size).handle);
+            break;
+
+        case DynamicOpType::FreeBox:
+            packer.FreeBox(op.handle);
+            break;
+
+        case DynamicOpType::PackBatch:
+            CheckHandle(op, FirstHandle(packer.PackBoxBatch(op.batch)));
+            break;
+
+        case DynamicOpType::PackSingleBin:
+        {
+            vector<RectMapping> mappings;
+            packer.BeginTransaction(true);
+            for (auto& box : op.batch)
+                packer.StageBox(box);
+            packer.CommitTransaction(mappings);
+            CheckHandle(op, FirstHandle(mappings));
+            break;
+        }
+        case DynamicOpType::Compact:
+            packer.Compact(op.maxMoves, op.timeLimit);
+            break;
+        }
+
+        return true;
+    }
+
+    int GetBinCount() const {
+        return (int)packer.GetBins().size();
+    }
+};
+
+// ConcurrentBinPacker can't free or compact, so those operations are skipped,
+// and handles aren't checked since skipped transactions shift them
+struct ConcurrentEngine
+{
+    unique_ptr<ConcurrentBinPacker> packer;
+
+    bool Run(const DynamicOp& op)
+    {
+        if (op.type == DynamicOpType::Start)
+        {
+            packer.reset(new ConcurrentBinPacker(op.size.x, op.padding, op.allowRotation));
+            return true;
+        }
+
+        if (!packer)
+            throw runtime_error("trace doesn't start with a start operation");
+
+        if (op.type == DynamicOpType::PackBox)
+        {
+            packer->PackBox(op.size);
+            return true;
+        }
+
+        if (op.type == DynamicOpType::PackBatch)
+        {
+            for (auto& box : op.batch)
+                packer->PackBox(box);
+
+            return true;
+        }
+
+        return false;
+    }
+
+    int GetBinCount() const {
+        return packer ? packer->GetBinCount() : 0;
+    }
+};
+
+static double Percentile(const vector<int64_t>& sorted, double p)
+{
+    size_t index = (size_t)(p * (sorted.size() - 1) + 0.5);
+    return sorted[index] / 1000.0;
+}
+
+int main(int argc, char* argv[])
+{
+    Options options;
+    const char* tracePath = nullptr;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+
+        if (arg == "-e" && hasValue) options.concurrent = (strcmp(argv[++i], "concurrent") == 0);
+        else if (arg == "-s" && hasValue) options.binSize = atoi(argv[++i]);
+        else if (arg == "-p" && hasValue) options.padding = atoi(argv[++i]);
+        else if (arg == "-r") options.rotation = 0;
+        else if (arg == "-R") options.rotation = 1;
+        else if (arg == "-h" || arg == "--help") { PrintUsage(); return 0; }
+        else if (arg[0] != '-' && !tracePath) tracePath = argv[i];
+        else { PrintUsage(); return 1; }
+    }
+
+    if (!tracePath) {
+        PrintUsage();
+        return 1;
+    }
+
+    try
+    {
+        MappedFile file(tracePath);
+        vector<DynamicOp> ops = ReadDynamicTrace(file.GetData(), file.GetSize());
+
+        vector<vector<int64_t>> latencies(NumOpTypes);
+        int skipped = 0;
+
+        auto start = chrono::steady_clock::now();
+
+        int binCount = options.concurrent
+            ? Replay<ConcurrentEngine>(ops, options, latencies, skipped)
+            : Replay<PackerEngine>(ops, options, latencies, skipped);
+
+        double total = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+
+        printf("%-12s %10s %10s %10s %10s %10s %10s\n", "op (us)", "count", "p50", "p90", "p99", "p99.9", "max");
+
+        for (int t = 1; t < NumOpTypes; ++t)
+        {
+            auto& samples = latencies[t];
+            if (samples.empty())
+                continue;
+
+            sort(samples.begin(), samples.end());
+
+            printf("%-12s %10zu %10.2f %10.2f %10.2f %10.2f %10.2f\n", OpNames[t], samples.size(),
+                Percentile(samples, 0.5), Percentile(samples, 0.9), Percentile(samples, 0.99),
+                Percentile(samples, 0.999), samples.back() / 1000.0);
+        }
+
+        if (skipped)
+            printf("skipped %d operations the engine doesn't support\n", skipped);
+
+        printf("bins: %d\ntotal: %.2f ms\n", binCount, total);
+    }
+    catch (const exception& e)
+    {
+        fprintf(stderr, "replay: %s\n", e.what());
+        return 1;
+    }
+
+    return 0;
+}